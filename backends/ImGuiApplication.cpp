@@ -1,4 +1,6 @@
 #include <stdint.h>
+#include <time.h>
+#include <algorithm>
 #include <filesystem>
 #include <string>
 
@@ -9,6 +11,7 @@
 #include "ImGuiApplication.h"
 
 #include "imgui_common_tools.h"
+#include "imgui_frame_profiler.h"
 #include "ApplicationSetting.h"
 
 using std::string;
@@ -144,6 +147,27 @@ void ImGuiApplication::preset()
     addSetting(
         SettingValue::SettingBool, "GUI VSync", [this](const void *val) { mGuiVSync = *((bool *)val); },
         [this](void *val) { *((bool *)val) = mGuiVSync; });
+    addSetting(
+        SettingValue::SettingBool, "GUI Power Saving", [this](const void *val) { mPowerSaving = *((bool *)val); },
+        [this](void *val) { *((bool *)val) = mPowerSaving; });
+    addSetting(
+        SettingValue::SettingInt, "GUI Idle Refresh Rate", [this](const void *val) { mIdleRefreshRate = *((int *)val); },
+        [this](void *val) { *((int *)val) = mIdleRefreshRate; });
+    addSetting(
+        SettingValue::SettingInt, "GUI FPS Limit", [this](const void *val) { mFpsLimit = *((int *)val); },
+        [this](void *val) { *((int *)val) = mFpsLimit; });
+    addSetting(
+        SettingValue::SettingInt, "GUI FPS Limit Unfocused", [this](const void *val) { mFpsLimitUnfocused = *((int *)val); },
+        [this](void *val) { *((int *)val) = mFpsLimitUnfocused; });
+    addSetting(
+        SettingValue::SettingInt, "GUI FPS Limit Minimized", [this](const void *val) { mFpsLimitMinimized = *((int *)val); },
+        [this](void *val) { *((int *)val) = mFpsLimitMinimized; });
+    addSetting(
+        SettingValue::SettingInt, "GUI Record FPS", [this](const void *val) { mRecordFps = *((int *)val); },
+        [this](void *val) { *((int *)val) = mRecordFps; });
+    addSetting(
+        SettingValue::SettingBool, "GUI Record Raw Frames", [this](const void *val) { mRecordRawFrames = *((bool *)val); },
+        [this](void *val) { *((bool *)val) = mRecordRawFrames; });
     addSetting(
         SettingValue::SettingBool, "Show Log Window", [this](const void *val) { mShowLogWindow = *((bool *)val); },
         [this](void *val) { *((bool *)val) = mShowLogWindow; });
@@ -209,6 +233,7 @@ void ImGuiApplication::preset()
     if (mMenuEnable)
     {
         addMenu({"Menu", "Settings"}, [this]() { mSettingsWindow.open(); });
+        addMenu({"Menu", "Record UI"}, [this]() { toggleRecording(); }, [this]() { return mRecorder.isRecording(); });
     }
     else
     {
@@ -230,11 +255,18 @@ void ImGuiApplication::addSettingArr(SettingValue::SettingType type, std::string
 
 void ImGuiApplication::showContent()
 {
-    if (renderUI())
+    getFrameProfiler().beginPhase(FramePhase_RenderUI);
+    bool needExit = renderUI();
+    getFrameProfiler().endPhase(FramePhase_RenderUI);
+    if (needExit)
         this->close();
 
+    mRecorder.update();
+
     if (mShowUIStatus)
         ImGui::ShowMetricsWindow(&mShowUIStatus);
+    if (mShowFrameProfiler)
+        ImGui::ShowFrameProfilerWindow(&mShowFrameProfiler);
 
     mLogger.show();
     if (mLogger.justClosed())
@@ -442,6 +474,52 @@ bool ImGuiApplication::VSyncEnabled()
     return mGuiVSync;
 }
 
+bool ImGuiApplication::PowerSavingEnabled()
+{
+    return mPowerSaving;
+}
+
+float ImGuiApplication::getIdleRefreshInterval()
+{
+    return 1.f / std::clamp(mIdleRefreshRate, 1, 60);
+}
+
+int ImGuiApplication::getFrameRateLimit(bool focused, bool minimized)
+{
+    if (minimized)
+        return mFpsLimitMinimized;
+    if (!focused)
+        return mFpsLimitUnfocused;
+    return mFpsLimit;
+}
+
+void ImGuiApplication::toggleRecording()
+{
+    if (mRecorder.isRecording())
+    {
+        mRecorder.stop();
+        ImGui::FrameRecorderStats stats = mRecorder.getStats();
+        addLog(combineString("record stopped: ", mRecorder.getPath(), " ", std::to_string(stats.width), "x",
+                             std::to_string(stats.height), " written ", std::to_string(stats.writtenFrames), " frames, dropped ",
+                             std::to_string(stats.busyDrops), " (readback busy) ", std::to_string(stats.queueDrops),
+                             " (disk busy)", stats.writeFailed ? ", write failed" : "", "\n"));
+        return;
+    }
+
+    char   name[64];
+    time_t now = time(nullptr);
+    strftime(name, sizeof(name), "record_%Y%m%d_%H%M%S", localtime(&now));
+
+    fs::path    path   = fs::u8path(mExePath).parent_path() / name;
+    std::string record = localToUtf8(path.string()) + (mRecordRawFrames ? "" : ".y4m");
+    if (mRecorder.start(record, mRecordRawFrames ? ImGui::FrameRecordFormat_RawI420 : ImGui::FrameRecordFormat_Y4M,
+                        [](const ImGui::FrameCaptureCallback &callback) { return ImGui::captureFrame(callback); },
+                        std::clamp(mRecordFps, 1, 120)))
+        addLog(combineString("record started: ", record, "\n"));
+    else
+        addLog(combineString("record start fail: ", record, "\n"));
+}
+
 void ImGuiApplication::onFontChanged(const std::string &fontPath, int fontIdx, float fontSize, bool applyNow)
 {
     mAppFontPath = fontPath;
@@ -945,8 +1023,28 @@ void ImGuiApplication::initSettingsWindow()
                               });
 
     addSettingWindowItemBool(settingPath, "V-Sync", &mGuiVSync);
+    addSettingWindowItemBool(settingPath, "Power Saving", &mPowerSaving, nullptr,
+                             "Only render when there is input or new content, to reduce CPU/GPU usage while idle");
+    addSettingWindowItemInt(settingPath, "Idle Refresh Rate", &mIdleRefreshRate, 1, 60, true, nullptr,
+                            "Frames per second at least when idle in power saving mode",
+                            [this]() { return !mPowerSaving; });
+    addSettingWindowItemInt(settingPath, "FPS Limit", &mFpsLimit, 0, 1000, true, nullptr, "0 for unlimited");
+    addSettingWindowItemInt(settingPath, "FPS Limit (Unfocused)", &mFpsLimitUnfocused, 0, 1000, true, nullptr,
+                            "Used when no window of the application is focused, 0 for unlimited");
+    addSettingWindowItemInt(settingPath, "FPS Limit (Minimized)", &mFpsLimitMinimized, 0, 1000, true, nullptr,
+                            "Used when the main window is minimized, 0 to only sleep 10 ms per loop");
+    addSettingWindowItemInt(settingPath, "Record FPS", &mRecordFps, 1, 120, true, nullptr,
+                            "Frame rate of Menu > Record UI, frames are dropped when the readback or the disk falls behind");
+    addSettingWindowItemBool(settingPath, "Record Raw Frames", &mRecordRawFrames, nullptr,
+                             "Write numbered I420 .yuv files into a directory instead of one .y4m file");
     addSettingWindowItemButton(
-        settingPath, "Show UI Status", [this]() { mShowUIStatus = true; }, "", [this]() { return mShowUIStatus; });
+        settingPath, "Show UI Status",
+        [this]()
+        {
+            mShowUIStatus      = true;
+            mShowFrameProfiler = true;
+        },
+        "", [this]() { return mShowUIStatus && mShowFrameProfiler; });
     if (mEnableFontChanging)
     {
         addSettingWindowItemButton(settingPath, "Font", [this]() { mFontChooser.open(); });
@@ -963,6 +1061,7 @@ void ImGuiApplication::initSettingsWindow()
 
 void ImGuiApplication::exit()
 {
+    mRecorder.stop();
     exitInternal();
     mFontChooser.exit();
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "ImGuiTools.h"
 #include "ImGuiWindow.h"
 #include "ApplicationSetting.h"
+#include "imgui_frame_recorder.h"
 #define ADD_APPLICATION_LOG(fmt, ...)                                 \
     do                                                                \
     {                                                                 \
@@ -132,9 +133,15 @@ namespace ImGui
         // load resources like Fonts; this should be called after preset() and configs loading, before first NewFrame(),
         void loadResources();
 
-        bool VSyncEnabled();
-        void restart();
-        void addLog(const std::string &logString);
+        bool  VSyncEnabled();
+        // wait for events between frames instead of rendering continuously
+        bool  PowerSavingEnabled();
+        // longest wait in power saving mode, in seconds
+        float getIdleRefreshInterval();
+        // frame rate cap of the current window state, 0 for unlimited
+        int   getFrameRateLimit(bool focused, bool minimized);
+        void  restart();
+        void  addLog(const std::string &logString);
 
     protected:
         // return if need to exit the application
@@ -218,7 +225,15 @@ namespace ImGui
         int         mAppFontIdx  = 0;
 
     protected:
-        bool mGuiVSync = true;
+        bool mGuiVSync          = true;
+        bool mPowerSaving       = false;
+        int  mIdleRefreshRate   = 1; // frames per second at least in power saving mode
+        // frame rate caps independent of V-Sync, 0 for unlimited
+        int  mFpsLimit          = 0;
+        int  mFpsLimitUnfocused = 0;
+        int  mFpsLimitMinimized = 20;
+        int  mRecordFps         = 30;
+        bool mRecordRawFrames   = false; // numbered .yuv files instead of one .y4m
         enum GUI_THEME : int
         {
             THEME_DARK,
@@ -229,7 +244,8 @@ namespace ImGui
 
     protected:
         // Not Saving
-        bool mShowUIStatus = false;
+        bool mShowUIStatus      = false;
+        bool mShowFrameProfiler = false;
 
     public:
         void onFontChanged(const std::string &fontPath, int fontIdx, float fontSize, bool applyNow);
@@ -245,6 +261,9 @@ namespace ImGui
         std::string        mCreateFilePath;
         ConfirmDialog      mCreateFileConfirmDialog;
         bool               mEnableFontChanging = true;
+
+        ImGui::FrameRecorder mRecorder;
+        void                 toggleRecording();
     };
 
 } // namespace ImGui
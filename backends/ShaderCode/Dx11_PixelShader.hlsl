@@ -11,6 +11,10 @@
 #define YUV_ColorRange_0_255 0
 #define YUV_ColorRange_16_235 1
 
+#define YUV_ColorSpace_BT601 0
+#define YUV_ColorSpace_BT709 1
+#define YUV_ColorSpace_BT2020 2
+
 struct PS_INPUT {
   float4 pos : SV_POSITION;
   float4 col : COLOR0;
@@ -26,6 +30,8 @@ cbuffer ConstantBuffer : register(b0) {
   int format;
   int useAreaSample;
   int textureColorRange;
+  float textureValueScale;
+  int textureColorSpace;
 };
 
 float3 yuvToRgb(float3 yuv) {
@@ -38,6 +44,14 @@ float3 yuvToRgb(float3 yuv) {
   float3x3 yuv2rgb = float3x3(float3(1.164383, 1.164383, 1.164383),
                               float3(0.000000, -0.391762, 2.017232),
                               float3(1.596027, -0.812968, 0.000000));
+  if (textureColorSpace == YUV_ColorSpace_BT709)
+    yuv2rgb = float3x3(float3(1.164383, 1.164383, 1.164383),
+                       float3(0.000000, -0.213249, 2.112402),
+                       float3(1.792741, -0.532909, 0.000000));
+  else if (textureColorSpace == YUV_ColorSpace_BT2020)
+    yuv2rgb = float3x3(float3(1.164383, 1.164383, 1.164383),
+                       float3(0.000000, -0.187326, 2.141772),
+                       float3(1.678674, -0.650424, 0.000000));
   float3 rgb = mul(yuv, yuv2rgb);
   return rgb;
 }
@@ -46,7 +60,7 @@ float4 simpleSampleTexture(int idx, float2 uv) {
   return gTextures[idx].Sample(gSampler, uv);
 }
 
-float4 sampleTexture(int idx, float2 uv) {
+float4 sampleTextureArea(int idx, float2 uv) {
   float2 texScale = textureShowingSize / renderSize;
 
   if (useAreaSample == 0 || texScale.x < 2.0 || texScale.y < 2.0) {
@@ -82,6 +96,11 @@ float4 sampleTexture(int idx, float2 uv) {
   return color / weight;
 }
 
+// samples of high bit depth formats may not use all bits of the component
+float4 sampleTexture(int idx, float2 uv) {
+  return sampleTextureArea(idx, uv) * textureValueScale;
+}
+
 float4 main(PS_INPUT input) : SV_Target {
 
   if (format == TextureFormat_Normal) {
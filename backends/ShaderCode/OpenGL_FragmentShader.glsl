@@ -11,11 +11,17 @@
 #define YUV_ColorRange_0_255  0
 #define YUV_ColorRange_16_235 1
 
+#define YUV_ColorSpace_BT601  0
+#define YUV_ColorSpace_BT709  1
+#define YUV_ColorSpace_BT2020 2
+
 uniform sampler2D Texture0;
 uniform sampler2D Texture1;
 uniform sampler2D Texture2;
 uniform int       TextureFormat;
 uniform int       TextureColorRange;
+uniform int       TextureColorSpace;
+uniform float     TextureValueScale;
 uniform vec2      TextureShowingSize;
 uniform vec2      TextureSize;
 uniform vec2      RenderSize;
@@ -36,7 +42,14 @@ vec3 yuvToRgb(vec3 yuv)
         yuv.r = (yuv.r - 0.06275);
         yuv   = yuv - vec3(0, 0.50196, 0.50196);
     }
-    vec3 rgb = mat3(1.164, 1.164, 1.164, 0., -0.39465, 2.03211, 1.596, -0.81300, 0) * yuv;
+    mat3 yuv2rgb;
+    if (TextureColorSpace == YUV_ColorSpace_BT709)
+        yuv2rgb = mat3(1.164, 1.164, 1.164, 0., -0.213, 2.112, 1.793, -0.533, 0);
+    else if (TextureColorSpace == YUV_ColorSpace_BT2020)
+        yuv2rgb = mat3(1.164, 1.164, 1.164, 0., -0.1873, 2.1418, 1.678, -0.6504, 0);
+    else
+        yuv2rgb = mat3(1.164, 1.164, 1.164, 0., -0.39465, 2.03211, 1.596, -0.81300, 0);
+    vec3 rgb = yuv2rgb * yuv;
 
     return clamp(rgb, 0.0, 1.0);
 }
@@ -51,7 +64,7 @@ vec4 simpleSampleTexture(int idx, vec2 uv)
         return texture(Texture2, uv);
 }
 
-vec4 sampleTexture(int idx, vec2 uv)
+vec4 sampleTextureArea(int idx, vec2 uv)
 {
     vec2 texScale = TextureShowingSize / RenderSize;
 
@@ -94,6 +107,12 @@ vec4 sampleTexture(int idx, vec2 uv)
     return color / weight;
 }
 
+// samples of high bit depth formats may not use all bits of the component
+vec4 sampleTexture(int idx, vec2 uv)
+{
+    return sampleTextureArea(idx, uv) * TextureValueScale;
+}
+
 void main()
 {
     if (TextureFormat == TextureFormat_Normal)
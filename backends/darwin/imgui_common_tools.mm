@@ -4,6 +4,9 @@
 #include <ios>
 #include <string>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <AppKit/AppKit.h>
 #import <AppKit/NSOpenPanel.h>
@@ -300,6 +303,64 @@ namespace ImGui
         return utf8ToUnicode(localToUtf8(str));
     }
 
+    bool openSharedMemory(const string &name, size_t size, bool create, SharedMemory &shm)
+    {
+        string shmName = (!name.empty() && name[0] == '/') ? name : "/" + name;
+        int    fd      = shm_open(shmName.c_str(), create ? (O_CREAT | O_RDWR | O_TRUNC) : O_RDWR, 0600);
+        if (fd < 0)
+        {
+            gLastError = combineString("shm_open ", shmName, " fail: ", getSystemError());
+            return false;
+        }
+        if (create)
+        {
+            if (ftruncate(fd, (off_t)size) != 0)
+            {
+                gLastError = combineString("ftruncate ", shmName, " fail: ", getSystemError());
+                close(fd);
+                shm_unlink(shmName.c_str());
+                return false;
+            }
+        }
+        else
+        {
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                gLastError = combineString("fstat ", shmName, " fail: ", getSystemError());
+                close(fd);
+                return false;
+            }
+            size = (size_t)st.st_size;
+        }
+
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            gLastError = combineString("mmap ", shmName, " fail: ", getSystemError());
+            if (create)
+                shm_unlink(shmName.c_str());
+            return false;
+        }
+
+        shm.name   = shmName;
+        shm.data   = data;
+        shm.size   = size;
+        shm.handle = 0;
+        shm.owner  = create;
+        return true;
+    }
+
+    void closeSharedMemory(SharedMemory &shm)
+    {
+        if (shm.data)
+            munmap(shm.data, shm.size);
+        if (shm.owner)
+            shm_unlink(shm.name.c_str());
+        shm = SharedMemory();
+    }
+
     std::string getSystemPictureFolder()
     {
         // TODO
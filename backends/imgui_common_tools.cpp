@@ -1,6 +1,8 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <thread>
 
 #include "imgui_common_tools.h"
@@ -18,6 +20,8 @@ namespace ImGui
 
     string gLastError;
 
+    static std::atomic<bool> gRedrawRequested(false);
+
     string getLastError()
     {
         string res = gLastError;
@@ -25,6 +29,133 @@ namespace ImGui
         return res;
     }
 
+    void requestRedraw()
+    {
+        // only the first request since the last frame needs to wake the loop
+        if (!gRedrawRequested.exchange(true, std::memory_order_acq_rel))
+            wakeMainLoop();
+    }
+
+    bool takeRedrawRequest()
+    {
+        return gRedrawRequested.exchange(false, std::memory_order_acq_rel);
+    }
+
+    // worker threads of runParallel(), started on first use
+    class ParallelPool
+    {
+    public:
+        ~ParallelPool()
+        {
+            {
+                StdMutexGuard lock(mLock);
+                mQuit = true;
+            }
+            mWorkCond.notify_all();
+            for (auto &worker : mWorkers)
+                worker.join();
+        }
+
+        void run(unsigned int taskCount, const std::function<void(unsigned int task)> &func)
+        {
+            StdMutexUniqueLock runLock(mRunLock, std::try_to_lock);
+            if (taskCount <= 1 || !runLock.owns_lock() || !start())
+            {
+                for (unsigned int task = 0; task < taskCount; task++)
+                    func(task);
+                return;
+            }
+
+            {
+                StdMutexGuard lock(mLock);
+                mFunc      = &func;
+                mTaskCount = taskCount;
+                mNextTask  = 0;
+                mDoneTasks = 0;
+                mJob++;
+            }
+            mWorkCond.notify_all();
+            runTasks();
+
+            // the job is cleared once no worker can still read it
+            StdMutexUniqueLock lock(mLock);
+            mDoneCond.wait(lock, [this]() { return mDoneTasks == mTaskCount && mActiveWorkers == 0; });
+            mFunc = nullptr;
+        }
+
+    private:
+        bool start()
+        {
+            StdMutexGuard lock(mLock);
+            if (mWorkers.empty())
+            {
+                unsigned int count = MIN(MAX(thread::hardware_concurrency(), 1u), 8u) - 1;
+                for (unsigned int i = 0; i < count; i++)
+                    mWorkers.emplace_back(&ParallelPool::worker, this);
+            }
+            return !mWorkers.empty();
+        }
+
+        void runTasks()
+        {
+            while (true)
+            {
+                unsigned int task = mNextTask.fetch_add(1);
+                if (task >= mTaskCount)
+                    return;
+                (*mFunc)(task);
+
+                StdMutexGuard lock(mLock);
+                if (++mDoneTasks == mTaskCount)
+                    mDoneCond.notify_all();
+            }
+        }
+
+        void worker()
+        {
+            uint64_t lastJob = 0;
+            while (true)
+            {
+                {
+                    StdMutexUniqueLock lock(mLock);
+                    mWorkCond.wait(lock, [&]() { return mQuit || mJob != lastJob; });
+                    if (mQuit)
+                        return;
+                    lastJob = mJob;
+                    if (!mFunc) // woke after the job was finished
+                        continue;
+                    mActiveWorkers++;
+                }
+                runTasks();
+                {
+                    StdMutexGuard lock(mLock);
+                    mActiveWorkers--;
+                }
+                mDoneCond.notify_all();
+            }
+        }
+
+        StdMutex                mRunLock; // one job at a time
+        StdMutex                mLock;
+        std::condition_variable mWorkCond;
+        std::condition_variable mDoneCond;
+        vector<thread>          mWorkers;
+        bool                    mQuit = false;
+
+        const std::function<void(unsigned int)> *mFunc          = nullptr;
+        uint64_t                                 mJob           = 0;
+        unsigned int                             mTaskCount     = 0;
+        std::atomic<unsigned int>                mNextTask{0};
+        unsigned int                             mDoneTasks     = 0;
+        unsigned int                             mActiveWorkers = 0;
+    };
+
+    void runParallel(unsigned int taskCount, const std::function<void(unsigned int task)> &func)
+    {
+        static ParallelPool pool;
+        pool.run(taskCount, func);
+    }
+
     const std::vector<FilterSpec> &getImageFilter()
     {
         static vector<FilterSpec> gImageFilterSpecs = {
@@ -2,6 +2,7 @@
 #define IMGUI_COMMON_TOOLS_H
 
 #include <stdint.h>
+#include <functional>
 #include <vector>
 #include <string>
 #include <memory>
@@ -127,6 +128,18 @@ namespace ImGui
 
     bool restartApplication(const std::string &scriptPath, const std::string &programPath);
 
+    struct SharedMemory
+    {
+        std::string name;
+        void       *data   = nullptr;
+        size_t      size   = 0;
+        uintptr_t   handle = 0;
+        bool        owner  = false; // created by us, removed on close
+    };
+    // create a named shared memory region of size bytes, or open an existing one (size ignored), and map it read-write
+    bool openSharedMemory(const std::string &name, size_t size, bool create, SharedMemory &shm);
+    void closeSharedMemory(SharedMemory &shm);
+
 #ifdef IMGUI_ENABLE_FREETYPE
 
     struct FreetypeFontInfo
@@ -156,8 +169,20 @@ namespace ImGui
     // End Platform Relative
     std::string getResourcesDir();
 
+    // ask the main loop for a new frame when it is idle in power saving mode, any thread
+    void requestRedraw();
+    // return and clear the pending redraw request, main loop only
+    bool takeRedrawRequest();
+
+    // call func(task) for every task below taskCount and return when all are done. The calling thread takes tasks too,
+    // the others run on up to 7 worker threads kept for the whole run, so per frame image work pays no thread startup.
+    // while another thread is using the workers the tasks all run on the calling thread
+    void runParallel(unsigned int taskCount, const std::function<void(unsigned int task)> &func);
+
     // Backend Relative
     void setApplicationTitle(const std::string &title);
+    // wake the main loop up from waiting for events, any thread
+    void wakeMainLoop();
 
     ImRect getDisplayWorkArea();
     ImRect getMainWindowRect();
@@ -0,0 +1,124 @@
+#include <math.h>
+#include <algorithm>
+#include <thread>
+
+#include "imgui_frame_pacer.h"
+
+namespace ImGui
+{
+    FramePacer::FramePacer()
+    {
+        resetStats();
+    }
+
+    void FramePacer::setTargetFps(int fps)
+    {
+        fps = std::max(fps, 0);
+        if (fps == mTargetFps)
+            return;
+
+        mTargetFps = fps;
+        mInterval  = fps > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))
+                             : Clock::duration::zero();
+        mDeadline  = Clock::now() + mInterval;
+        resetStats();
+    }
+
+    void FramePacer::resetStats()
+    {
+        mHasLastFrame  = false;
+        mIntervalCount = 0;
+        for (auto &ms : mIntervalsMs)
+            ms = 0;
+    }
+
+    void FramePacer::sleepUntil(Clock::time_point deadline)
+    {
+        // sleep in 1 ms steps while the remaining time is above the expected oversleep, spin the rest
+        while (true)
+        {
+            Clock::time_point now       = Clock::now();
+            double            remaining = std::chrono::duration<double, std::milli>(deadline - now).count();
+            double            estimate  = mSleepMean + sqrt(mSleepM2 / mSleepCount);
+            if (remaining <= estimate)
+                break;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            double slept = std::chrono::duration<double, std::milli>(Clock::now() - now).count();
+            mSleepCount++;
+            double delta = slept - mSleepMean;
+            mSleepMean += delta / mSleepCount;
+            mSleepM2 += delta * (slept - mSleepMean);
+        }
+
+        while (Clock::now() < deadline)
+            std::this_thread::yield();
+    }
+
+    void FramePacer::wait()
+    {
+        if (mTargetFps > 0)
+        {
+            sleepUntil(mDeadline);
+
+            Clock::time_point now = Clock::now();
+            mDeadline += mInterval;
+            if (mDeadline <= now) // more than one interval late, start over from this frame
+                mDeadline = now + mInterval;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (mHasLastFrame)
+        {
+            mIntervalsMs[mIntervalCount % IMGUI_FRAME_PACER_HISTORY] =
+                std::chrono::duration<float, std::milli>(now - mLastFrame).count();
+            mIntervalCount++;
+        }
+        mLastFrame    = now;
+        mHasLastFrame = true;
+    }
+
+    FramePacingStats FramePacer::getStats() const
+    {
+        FramePacingStats stats = {};
+
+        stats.targetMs     = mTargetFps > 0 ? 1000.f / mTargetFps : 0;
+        stats.sampleCount  = std::min<uint32_t>(mIntervalCount, IMGUI_FRAME_PACER_HISTORY);
+        stats.sleepSlackMs = (float)(mSleepMean + sqrt(mSleepM2 / mSleepCount) - 1.0);
+        if (stats.sampleCount == 0)
+            return stats;
+
+        float errors[IMGUI_FRAME_PACER_HISTORY];
+        float sum = 0;
+        for (uint32_t i = 0; i < stats.sampleCount; i++)
+            sum += mIntervalsMs[i];
+        stats.averageMs = sum / stats.sampleCount;
+
+        float variance = 0;
+        for (uint32_t i = 0; i < stats.sampleCount; i++)
+        {
+            float interval = mIntervalsMs[i];
+            variance += (interval - stats.averageMs) * (interval - stats.averageMs);
+
+            // without a target the error is measured against the average
+            float target = stats.targetMs > 0 ? stats.targetMs : stats.averageMs;
+            errors[i]    = fabsf(interval - target);
+            if (stats.targetMs > 0 && interval > stats.targetMs * 1.5f)
+                stats.lateFrames++;
+        }
+        stats.jitterMs = sqrtf(variance / stats.sampleCount);
+
+        std::sort(errors, errors + stats.sampleCount);
+        stats.maxErrorMs = errors[stats.sampleCount - 1];
+        stats.p99ErrorMs = errors[(size_t)((stats.sampleCount - 1) * 0.99f + 0.5f)];
+        return stats;
+    }
+
+    FramePacer &getFramePacer()
+    {
+        static FramePacer pacer;
+        return pacer;
+    }
+
+} // namespace ImGui
@@ -0,0 +1,67 @@
+#ifndef IMGUI_FRAME_PACER_H_
+#define IMGUI_FRAME_PACER_H_
+
+#include <chrono>
+#include <stdint.h>
+
+#define IMGUI_FRAME_PACER_HISTORY 256
+
+namespace ImGui
+{
+    struct FramePacingStats
+    {
+        float    targetMs;     // 0 if the frame rate is not limited
+        float    averageMs;    // average interval between frames
+        float    jitterMs;     // standard deviation of the intervals
+        float    p99ErrorMs;   // 99th percentile of |interval - target|
+        float    maxErrorMs;   // largest |interval - target|
+        uint32_t lateFrames;   // intervals longer than 1.5 x target
+        uint32_t sampleCount;  // intervals in the statistics, up to IMGUI_FRAME_PACER_HISTORY
+        float    sleepSlackMs; // estimated oversleep of a 1 ms sleep, the rest of the wait is spun
+    };
+
+    // Frame rate limiter independent of V-Sync.
+    // wait() is called once per frame, it sleeps while the deadline is far enough for the OS scheduler to be trusted,
+    // then spins until the deadline so frames land evenly. Deadlines advance by a fixed interval from the previous
+    // one, a frame later than a whole interval restarts the schedule instead of rushing to catch up.
+    class FramePacer
+    {
+    public:
+        FramePacer();
+        FramePacer(const FramePacer &)            = delete;
+        FramePacer &operator=(const FramePacer &) = delete;
+
+        // 0 for unlimited, the statistics are reset when the target changes
+        void setTargetFps(int fps);
+        int  targetFps() const { return mTargetFps; }
+
+        void wait();
+
+        FramePacingStats getStats() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        void sleepUntil(Clock::time_point deadline);
+        void resetStats();
+
+        int               mTargetFps = 0;
+        Clock::duration   mInterval  = Clock::duration::zero();
+        Clock::time_point mDeadline;
+        Clock::time_point mLastFrame;
+        bool              mHasLastFrame = false;
+
+        float    mIntervalsMs[IMGUI_FRAME_PACER_HISTORY];
+        uint32_t mIntervalCount = 0; // total recorded since the last reset
+
+        // running mean/variance of a 1 ms sleep duration (Welford)
+        double   mSleepMean  = 1.0;
+        double   mSleepM2    = 0;
+        uint64_t mSleepCount = 1;
+    };
+
+    FramePacer &getFramePacer();
+
+} // namespace ImGui
+
+#endif
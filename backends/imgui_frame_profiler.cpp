@@ -0,0 +1,307 @@
+#include <float.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_common_tools.h"
+#include "imgui_frame_pacer.h"
+#include "imgui_frame_profiler.h"
+#if IMGUI_RENDER_API == IMGUI_RENDER_API_OPENGL
+    #include "imgui_impl_opengl3.h"
+    #include "imgui_internal.h" // ImGuiWindow::DrawList, names the draw lists timed on the GPU
+#endif
+
+#define FRAME_PROFILER_HISTOGRAM_BINS 40
+
+namespace ImGui
+{
+    FrameProfiler::FrameProfiler() : mFrameCount(0)
+    {
+        for (auto &slot : mSlots)
+        {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            slot.totalMs.store(0, std::memory_order_relaxed);
+            for (auto &ms : slot.phaseMs)
+                ms.store(0, std::memory_order_relaxed);
+        }
+        for (auto &ms : mPhaseMs)
+            ms = 0;
+    }
+
+    void FrameProfiler::beginFrame()
+    {
+        if (!mEnabled)
+            return;
+        mInFrame    = true;
+        mFrameStart = Clock::now();
+        for (auto &ms : mPhaseMs)
+            ms = 0;
+    }
+
+    void FrameProfiler::endFrame()
+    {
+        if (!mInFrame)
+            return;
+        mInFrame = false;
+
+        float    totalMs = std::chrono::duration<float, std::milli>(Clock::now() - mFrameStart).count();
+        uint64_t frame   = mFrameCount.load(std::memory_order_relaxed);
+        Slot    &slot    = mSlots[frame % IMGUI_FRAME_PROFILER_FRAMES];
+
+        slot.sequence.store(frame * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.totalMs.store(totalMs, std::memory_order_relaxed);
+        for (int i = 0; i < FramePhase_Count; i++)
+            slot.phaseMs[i].store(mPhaseMs[i], std::memory_order_relaxed);
+        slot.sequence.store((frame + 1) * 2, std::memory_order_release);
+        mFrameCount.store(frame + 1, std::memory_order_release);
+    }
+
+    void FrameProfiler::beginPhase(FramePhase phase)
+    {
+        if (mInFrame)
+            mPhaseStart[phase] = Clock::now();
+    }
+
+    void FrameProfiler::endPhase(FramePhase phase)
+    {
+        // a phase entered several times in a frame is summed
+        if (mInFrame)
+            mPhaseMs[phase] += std::chrono::duration<float, std::milli>(Clock::now() - mPhaseStart[phase]).count();
+    }
+
+    unsigned int FrameProfiler::getFrames(FrameTiming *frames, unsigned int maxCount) const
+    {
+        uint64_t frameCount = mFrameCount.load(std::memory_order_acquire);
+        uint64_t available  = std::min<uint64_t>(frameCount, IMGUI_FRAME_PROFILER_FRAMES);
+        uint64_t first      = frameCount - std::min<uint64_t>(available, maxCount);
+
+        unsigned int copied = 0;
+        for (uint64_t frame = first; frame < frameCount; frame++)
+        {
+            const Slot &slot     = mSlots[frame % IMGUI_FRAME_PROFILER_FRAMES];
+            uint64_t    sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != (frame + 1) * 2)
+                continue;
+
+            FrameTiming &timing = frames[copied];
+            timing.frameIndex   = frame;
+            timing.totalMs      = slot.totalMs.load(std::memory_order_relaxed);
+            for (int i = 0; i < FramePhase_Count; i++)
+                timing.phaseMs[i] = slot.phaseMs[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+                continue;
+            copied++;
+        }
+        return copied;
+    }
+
+    const char *FrameProfiler::getPhaseName(FramePhase phase)
+    {
+        static const char *names[FramePhase_Count] = {
+            "NewFrame", "PreAction", "Show", "  RenderUI", "Render", "RenderDrawData", "PlatformWindows", "Swap", "Pace",
+        };
+        if (phase < 0 || phase >= FramePhase_Count)
+            return "Unknown";
+        return names[phase];
+    }
+
+    FrameProfiler &getFrameProfiler()
+    {
+        static FrameProfiler profiler;
+        return profiler;
+    }
+
+    // values of one phase in frame order, -1 for the frame total
+    static void getPhaseValues(const FrameTiming *frames, unsigned int count, int phase, std::vector<float> &values)
+    {
+        values.resize(count);
+        for (unsigned int i = 0; i < count; i++)
+            values[i] = phase < 0 ? frames[i].totalMs : frames[i].phaseMs[phase];
+    }
+
+    static float getPercentile(const std::vector<float> &sorted, float percent)
+    {
+        if (sorted.empty())
+            return 0;
+        size_t index = (size_t)(percent / 100.f * (sorted.size() - 1) + 0.5f);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+#if IMGUI_RENDER_API == IMGUI_RENDER_API_OPENGL
+    // window owning drawList, the timings are a few frames old so the window may be gone
+    static const char *getDrawListOwner(const ImDrawList *drawList)
+    {
+        for (ImGuiWindow *window : GImGui->Windows)
+        {
+            if (window->DrawList == drawList)
+                return window->Name;
+        }
+        if (drawList == GetBackgroundDrawList())
+            return "(background)";
+        if (drawList == GetForegroundDrawList())
+            return "(foreground)";
+        return "(closed window)";
+    }
+
+    static void showGpuTimings()
+    {
+        SeparatorText("GPU");
+        if (!ImGui_ImplOpenGL3_GpuTimersSupported())
+        {
+            TextUnformatted("Timer queries need OpenGL 3.3");
+            return;
+        }
+
+        static bool timeImages = false;
+        bool        enabled    = ImGui_ImplOpenGL3_GpuTimersEnabled();
+        bool        changed    = Checkbox("GPU Timers", &enabled);
+        SameLine();
+        changed |= Checkbox("Time Images Apart", &timeImages);
+        if (changed)
+            ImGui_ImplOpenGL3_SetGpuTimersEnabled(enabled, timeImages);
+
+        ImGui_ImplOpenGL3_StateStats stateStats = ImGui_ImplOpenGL3_GetStateStats();
+        Text("State calls %u issued, %u skipped", stateStats.IssuedCalls, stateStats.SkippedCalls);
+        if (!enabled)
+            return;
+
+        const ImGui_ImplOpenGL3_GpuTiming *timings = nullptr;
+        int                                count   = ImGui_ImplOpenGL3_GetGpuTimings(&timings);
+        float                              totalMs = 0;
+        for (int i = 0; i < count; i++)
+            totalMs += timings[i].TotalMs;
+        Text("Main viewport %.3f ms", totalMs);
+        TextDisabled("Only the main viewport is timed, windows dragged out to their own viewports are not listed");
+
+        if (count > 0 && BeginTable("gpu", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            const char *columns[] = {"Window", "GPU (ms)", "Images (ms)", "Images"};
+            for (auto column : columns)
+                TableSetupColumn(column);
+            TableHeadersRow();
+
+            for (int i = 0; i < count; i++)
+            {
+                TableNextRow();
+                TableNextColumn();
+                TextUnformatted(getDrawListOwner(timings[i].DrawList));
+                TableNextColumn();
+                Text("%.3f", timings[i].TotalMs);
+                TableNextColumn();
+                if (timeImages)
+                    Text("%.3f", timings[i].ImageMs);
+                else
+                    TextUnformatted("-");
+                TableNextColumn();
+                Text("%d", timings[i].ImageCommands);
+            }
+            EndTable();
+        }
+    }
+#endif
+
+    void ShowFrameProfilerWindow(bool *open)
+    {
+        static FrameTiming        frames[IMGUI_FRAME_PROFILER_FRAMES];
+        static std::vector<float> values;
+        static std::vector<float> sorted;
+        static int                selectedPhase = -1; // -1 for the frame total
+        static int                frameWindow   = IMGUI_FRAME_PROFILER_FRAMES;
+
+        if (!Begin("Frame Profiler", open))
+        {
+            End();
+            return;
+        }
+
+        FrameProfiler &profiler = getFrameProfiler();
+        bool           enabled  = profiler.enabled();
+        if (Checkbox("Enabled", &enabled))
+            profiler.setEnabled(enabled);
+        SameLine();
+        SetNextItemWidth(GetFontSize() * 12);
+        SliderInt("Frames", &frameWindow, 16, IMGUI_FRAME_PROFILER_FRAMES);
+
+        unsigned int count = profiler.getFrames(frames, (unsigned int)frameWindow);
+        if (count == 0)
+        {
+            TextUnformatted("No frame recorded");
+            End();
+            return;
+        }
+
+        if (BeginTable("phases", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            const char *columns[] = {"Phase (ms)", "Last", "Avg", "P50", "P95", "P99", "Max"};
+            for (auto column : columns)
+                TableSetupColumn(column);
+            TableHeadersRow();
+
+            for (int phase = -1; phase < FramePhase_Count; phase++)
+            {
+                getPhaseValues(frames, count, phase, values);
+                sorted = values;
+                std::sort(sorted.begin(), sorted.end());
+                float sum = 0;
+                for (float ms : values)
+                    sum += ms;
+
+                TableNextRow();
+                TableNextColumn();
+                const char *name = phase < 0 ? "Frame" : FrameProfiler::getPhaseName((FramePhase)phase);
+                if (Selectable(name, selectedPhase == phase, ImGuiSelectableFlags_SpanAllColumns))
+                    selectedPhase = phase;
+                TableNextColumn();
+                Text("%.3f", values.back());
+                TableNextColumn();
+                Text("%.3f", sum / count);
+                TableNextColumn();
+                Text("%.3f", getPercentile(sorted, 50));
+                TableNextColumn();
+                Text("%.3f", getPercentile(sorted, 95));
+                TableNextColumn();
+                Text("%.3f", getPercentile(sorted, 99));
+                TableNextColumn();
+                Text("%.3f", sorted.back());
+            }
+            EndTable();
+        }
+
+        // timeline and distribution of the selected row
+        getPhaseValues(frames, count, selectedPhase, values);
+        float maxMs = *std::max_element(values.begin(), values.end());
+        if (maxMs <= 0)
+            maxMs = 1;
+        const char *name = selectedPhase < 0 ? "Frame" : FrameProfiler::getPhaseName((FramePhase)selectedPhase);
+        Text("%s, last %u frames", name, count);
+        PlotLines("Timeline", values.data(), (int)values.size(), 0, nullptr, 0, maxMs, ImVec2(0, GetFontSize() * 5));
+
+        float bins[FRAME_PROFILER_HISTOGRAM_BINS] = {0};
+        for (float ms : values)
+            bins[std::min((int)(ms / maxMs * FRAME_PROFILER_HISTOGRAM_BINS), FRAME_PROFILER_HISTOGRAM_BINS - 1)]++;
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "0 ~ %.2f ms", maxMs);
+        PlotHistogram("Histogram", bins, FRAME_PROFILER_HISTOGRAM_BINS, 0, overlay, 0, FLT_MAX, ImVec2(0, GetFontSize() * 5));
+
+        FramePacingStats pacing = getFramePacer().getStats();
+        SeparatorText("Pacing");
+        if (pacing.targetMs > 0)
+            Text("Target %.3f ms (%d fps), %u late frames", pacing.targetMs, getFramePacer().targetFps(), pacing.lateFrames);
+        else
+            TextUnformatted("Frame rate not limited");
+        Text("Interval avg %.3f ms, jitter %.3f ms", pacing.averageMs, pacing.jitterMs);
+        Text("Error p99 %.3f ms, max %.3f ms over %u frames", pacing.p99ErrorMs, pacing.maxErrorMs, pacing.sampleCount);
+        Text("Sleep slack %.3f ms", pacing.sleepSlackMs);
+
+#if IMGUI_RENDER_API == IMGUI_RENDER_API_OPENGL
+        showGpuTimings();
+#endif
+
+        End();
+    }
+
+} // namespace ImGui
@@ -0,0 +1,100 @@
+#ifndef IMGUI_FRAME_PROFILER_H_
+#define IMGUI_FRAME_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+#define IMGUI_FRAME_PROFILER_FRAMES 512
+
+namespace ImGui
+{
+    // stages of doGUIRender() in the main loops
+    enum FramePhase
+    {
+        FramePhase_NewFrame,        // renderer and platform NewFrame
+        FramePhase_PreAction,       // updateTextureStreams(), newFramePreAction()
+        FramePhase_Show,            // gUserApp->show(), FramePhase_RenderUI included
+        FramePhase_RenderUI,        // renderUI() of the application
+        FramePhase_Render,          // ImGui::Render(), endFramePostAction()
+        FramePhase_RenderDrawData,  // clear and draw of the main viewport
+        FramePhase_PlatformWindows, // UpdatePlatformWindows(), RenderPlatformWindowsDefault()
+        FramePhase_Swap,            // swap buffers / present, vsync wait included
+        FramePhase_Pace,            // frame rate limiter wait
+
+        FramePhase_Count,
+    };
+
+    struct FrameTiming
+    {
+        uint64_t frameIndex;
+        float    totalMs; // from beginFrame() to endFrame()
+        float    phaseMs[FramePhase_Count];
+    };
+
+    // Phase timers of the last IMGUI_FRAME_PROFILER_FRAMES frames.
+    // Written by the render thread only, every slot is guarded by a sequence number (seqlock) so any thread can read the
+    // history without blocking it, a slot overwritten while being read is skipped.
+    class FrameProfiler
+    {
+    public:
+        FrameProfiler();
+        FrameProfiler(const FrameProfiler &)            = delete;
+        FrameProfiler &operator=(const FrameProfiler &) = delete;
+
+        // render thread
+        void beginFrame();
+        void endFrame();
+        void beginPhase(FramePhase phase);
+        void endPhase(FramePhase phase);
+
+        // any thread, copy up to maxCount complete frames, oldest first. return the count copied
+        unsigned int getFrames(FrameTiming *frames, unsigned int maxCount) const;
+        uint64_t     frameCount() const { return mFrameCount.load(std::memory_order_acquire); }
+
+        void setEnabled(bool enabled) { mEnabled = enabled; }
+        bool enabled() const { return mEnabled; }
+
+        static const char *getPhaseName(FramePhase phase);
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Slot
+        {
+            std::atomic<uint64_t> sequence;
+            std::atomic<float>    totalMs;
+            std::atomic<float>    phaseMs[FramePhase_Count];
+        };
+
+        Slot                  mSlots[IMGUI_FRAME_PROFILER_FRAMES];
+        std::atomic<uint64_t> mFrameCount;
+        bool                  mEnabled  = true;
+        bool                  mInFrame  = false;
+        Clock::time_point     mFrameStart;
+        Clock::time_point     mPhaseStart[FramePhase_Count];
+        float                 mPhaseMs[FramePhase_Count];
+    };
+
+    FrameProfiler &getFrameProfiler();
+
+    // times the enclosing scope as one phase of the current frame
+    class FramePhaseScope
+    {
+    public:
+        explicit FramePhaseScope(FramePhase phase) : mPhase(phase) { getFrameProfiler().beginPhase(phase); }
+        ~FramePhaseScope() { getFrameProfiler().endPhase(mPhase); }
+        FramePhaseScope(const FramePhaseScope &)            = delete;
+        FramePhaseScope &operator=(const FramePhaseScope &) = delete;
+
+    private:
+        FramePhase mPhase;
+    };
+
+    // "Frame Profiler" window with percentiles per phase, a histogram of the selected one, the frame pacing statistics
+    // and the GPU time per window with the OpenGL backend
+    void ShowFrameProfilerWindow(bool *open = nullptr);
+
+} // namespace ImGui
+
+#endif
@@ -0,0 +1,321 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "imgui_common_tools.h"
+#include "imgui_frame_recorder.h"
+#include "ImGuiBaseTypes.h"
+
+namespace ImGui
+{
+    struct FrameRecordSession
+    {
+        FrameRecordFormat    format;
+        ImGuiImageColorSpace colorSpace;
+        std::string          path;
+        int                  fps;
+        FILE                *file = nullptr; // y4m only
+
+        StdMutex                          lock;
+        std::condition_variable           cond;
+        std::deque<std::vector<uint8_t>>  queue;
+        std::vector<std::vector<uint8_t>> freeBuffers; // recycled by the writer
+        bool                              closing = false;
+        unsigned int                      width   = 0; // set by the first frame
+        unsigned int                      height  = 0;
+        std::thread                       writer;
+
+        std::atomic<int>      inFlight{0}; // captures requested and not called back yet
+        std::atomic<uint64_t> capturedFrames{0};
+        std::atomic<uint64_t> writtenFrames{0};
+        std::atomic<uint64_t> busyDrops{0};
+        std::atomic<uint64_t> queueDrops{0};
+        std::atomic<uint64_t> writtenBytes{0};
+        std::atomic<bool>     writeFailed{false};
+    };
+
+    static void setI420Planes(uint8_t *data, unsigned int width, unsigned int height, ImGuiImageColorSpace colorSpace,
+                              ImageData &image)
+    {
+        image            = {};
+        image.plane[0]   = data;
+        image.plane[1]   = data + width * height;
+        image.plane[2]   = image.plane[1] + (width / 2) * (height / 2);
+        image.stride[0]  = width;
+        image.stride[1]  = width / 2;
+        image.stride[2]  = width / 2;
+        image.width      = width;
+        image.height     = height;
+        image.format     = ImGuiImageFormat_YUV420P;
+        image.colorRange = ImGuiImageColorRange_16_235;
+        image.colorSpace = colorSpace;
+    }
+
+    // capture worker thread
+    static void onFrameCaptured(FrameRecordSession &session, ImageData &image)
+    {
+        session.inFlight--;
+        if (image.width < 2 || image.height < 2 || image.format != ImGuiImageFormat_RGBA)
+            return;
+
+        std::vector<uint8_t> buffer;
+        unsigned int         width, height;
+        {
+            StdMutexGuard lock(session.lock);
+            if (session.closing)
+                return;
+            if (session.queue.size() >= IMGUI_FRAME_RECORDER_QUEUE)
+            {
+                session.queueDrops++;
+                return;
+            }
+            if (session.width == 0)
+            {
+                session.width  = image.width & ~1u;
+                session.height = image.height & ~1u;
+            }
+            width  = session.width;
+            height = session.height;
+            if (!session.freeBuffers.empty())
+            {
+                buffer = std::move(session.freeBuffers.back());
+                session.freeBuffers.pop_back();
+            }
+        }
+        buffer.resize(width * height * 3 / 2);
+
+        ImageData frame;
+        setI420Planes(buffer.data(), width, height, session.colorSpace, frame);
+
+        bool converted;
+        if (image.width == width && image.height == height)
+        {
+            converted = convertRGBAToI420(image.plane[0], image.stride[0], frame);
+        }
+        else
+        {
+            // keep the size of the recording, crop or pad with black
+            memset(frame.plane[0], 16, width * height);
+            memset(frame.plane[1], 128, width * height / 2);
+
+            ImageData roi;
+            converted = getImageDataROI(frame, 0, 0, std::min(width, image.width & ~1u),
+                                        std::min(height, image.height & ~1u), roi)
+                     && convertRGBAToI420(image.plane[0], image.stride[0], roi);
+        }
+        if (!converted)
+            return;
+
+        {
+            StdMutexGuard lock(session.lock);
+            if (session.closing)
+                return;
+            session.queue.push_back(std::move(buffer));
+        }
+        session.capturedFrames++;
+        session.cond.notify_one();
+    }
+
+    static bool writeFrame(FrameRecordSession &session, const std::vector<uint8_t> &frame, uint64_t index)
+    {
+        if (session.format == FrameRecordFormat_Y4M)
+        {
+            if (index == 0)
+            {
+                int header = fprintf(session.file, "YUV4MPEG2 W%u H%u F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                                     session.width, session.height, session.fps);
+                if (header < 0)
+                    return false;
+                session.writtenBytes += header;
+            }
+
+            if (fputs("FRAME\n", session.file) < 0)
+                return false;
+            if (fwrite(frame.data(), 1, frame.size(), session.file) != frame.size())
+                return false;
+            session.writtenBytes += frame.size() + 6;
+            return true;
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "frame_%06llu_%ux%u.yuv", (unsigned long long)index, session.width,
+                 session.height);
+        std::string path = session.path + "/" + name;
+
+        FILE *fp = fopen(utf8ToLocal(path).c_str(), "wb");
+        if (!fp)
+            return false;
+        bool written = fwrite(frame.data(), 1, frame.size(), fp) == frame.size();
+        written      = fclose(fp) == 0 && written;
+        if (written)
+            session.writtenBytes += frame.size();
+        return written;
+    }
+
+    static void writerThread(FrameRecordSession *session)
+    {
+        uint64_t index = 0;
+        while (true)
+        {
+            std::vector<uint8_t> frame;
+            {
+                StdMutexUniqueLock lock(session->lock);
+                session->cond.wait(lock, [session]() { return session->closing || !session->queue.empty(); });
+                if (session->queue.empty())
+                    break;
+                frame = std::move(session->queue.front());
+                session->queue.pop_front();
+            }
+
+            // after a failure the frames are only drained so stop() doesn't hang
+            if (!session->writeFailed)
+            {
+                if (writeFrame(*session, frame, index))
+                {
+                    index++;
+                    session->writtenFrames++;
+                }
+                else
+                {
+                    dbg("write frame %llu to %s fail\n", (unsigned long long)index, session->path.c_str());
+                    session->writeFailed = true;
+                }
+            }
+
+            StdMutexGuard lock(session->lock);
+            session->freeBuffers.push_back(std::move(frame));
+        }
+
+        if (session->file)
+        {
+            if (fclose(session->file) != 0)
+                session->writeFailed = true;
+            session->file = nullptr;
+        }
+    }
+
+    FrameRecorder::~FrameRecorder()
+    {
+        stop();
+    }
+
+    bool FrameRecorder::start(const std::string &path, FrameRecordFormat format, const FrameRecordSource &source, int fps,
+                              ImGuiImageColorSpace colorSpace)
+    {
+        stop();
+        if (!source || fps <= 0 || format < 0 || format >= FrameRecordFormat_Max)
+        {
+            dbg("invalid record parameters\n");
+            return false;
+        }
+
+        std::shared_ptr<FrameRecordSession> session = std::make_shared<FrameRecordSession>();
+
+        session->format     = format;
+        session->colorSpace = colorSpace;
+        session->path       = path;
+        session->fps        = fps;
+
+        if (format == FrameRecordFormat_Y4M)
+        {
+            session->file = fopen(utf8ToLocal(path).c_str(), "wb");
+            if (!session->file)
+            {
+                dbg("open %s fail\n", path.c_str());
+                return false;
+            }
+        }
+        else
+        {
+            std::error_code err;
+            std::filesystem::create_directories(std::filesystem::u8path(path), err);
+            if (err)
+            {
+                dbg("create %s fail: %s\n", path.c_str(), err.message().c_str());
+                return false;
+            }
+        }
+
+        session->writer = std::thread(writerThread, session.get());
+
+        mSession     = session;
+        mSource      = source;
+        mPath        = path;
+        mInterval    = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+        mNextCapture = Clock::now();
+        mLastStats   = {};
+        return true;
+    }
+
+    void FrameRecorder::stop()
+    {
+        if (!mSession)
+            return;
+
+        {
+            StdMutexGuard lock(mSession->lock);
+            mSession->closing = true;
+        }
+        mSession->cond.notify_one();
+        mSession->writer.join();
+
+        mLastStats = getStats();
+        mSession.reset(); // captures still in flight keep it alive and return early
+        mSource = nullptr;
+    }
+
+    void FrameRecorder::update()
+    {
+        if (!mSession)
+            return;
+
+        Clock::time_point now = Clock::now();
+        if (now < mNextCapture)
+            return;
+        mNextCapture += mInterval;
+        if (mNextCapture <= now) // fell behind by more than a frame, don't burst
+            mNextCapture = now + mInterval;
+
+        if (mSession->inFlight >= IMGUI_CAPTURE_BUFFERS)
+        {
+            mSession->busyDrops++;
+            return;
+        }
+
+        mSession->inFlight++;
+        std::shared_ptr<FrameRecordSession> session = mSession;
+        if (!mSource([session](ImageData &image) { onFrameCaptured(*session, image); }))
+        {
+            mSession->inFlight--;
+            mSession->busyDrops++;
+        }
+    }
+
+    FrameRecorderStats FrameRecorder::getStats() const
+    {
+        if (!mSession)
+            return mLastStats;
+
+        FrameRecorderStats stats = {};
+
+        stats.capturedFrames = mSession->capturedFrames;
+        stats.writtenFrames  = mSession->writtenFrames;
+        stats.busyDrops      = mSession->busyDrops;
+        stats.queueDrops     = mSession->queueDrops;
+        stats.writtenBytes   = mSession->writtenBytes;
+        stats.writeFailed    = mSession->writeFailed;
+
+        StdMutexGuard lock(mSession->lock);
+        stats.queuedFrames = (unsigned int)mSession->queue.size();
+        stats.width        = mSession->width;
+        stats.height       = mSession->height;
+        return stats;
+    }
+
+} // namespace ImGui
@@ -0,0 +1,80 @@
+#ifndef IMGUI_FRAME_RECORDER_H_
+#define IMGUI_FRAME_RECORDER_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "imgui_image_render.h"
+
+#define IMGUI_FRAME_RECORDER_QUEUE 8 // frames waiting for the writer, further ones are dropped
+
+namespace ImGui
+{
+    enum FrameRecordFormat
+    {
+        FrameRecordFormat_Y4M,      // one .y4m file, 4:2:0 limited range
+        FrameRecordFormat_RawI420, // numbered .yuv files of I420 in a directory
+
+        FrameRecordFormat_Max,
+    };
+
+    // captures one frame and calls back with it, captureFrame() or ImageWindow::captureImage()
+    typedef std::function<bool(const FrameCaptureCallback &callback)> FrameRecordSource;
+
+    struct FrameRecorderStats
+    {
+        uint64_t     capturedFrames;  // read back and queued
+        uint64_t     writtenFrames;
+        uint64_t     busyDrops;       // previous captures still in flight
+        uint64_t     queueDrops;      // writer queue full, the disk can't keep up
+        uint64_t     writtenBytes;
+        unsigned int queuedFrames;
+        unsigned int width;           // of the recording, set by the first frame
+        unsigned int height;
+        bool         writeFailed;
+    };
+
+    struct FrameRecordSession;
+
+    // Records a FrameRecordSource at a fixed rate. update() requests a capture when a frame is due, the readback
+    // callback converts it to I420 and a dedicated thread writes it, frames are dropped and counted instead of
+    // blocking the UI when the readback or the disk is behind.
+    // The size of the first frame is kept, later frames of another size are cropped or padded with black.
+    class FrameRecorder
+    {
+    public:
+        FrameRecorder() = default;
+        ~FrameRecorder();
+        FrameRecorder(const FrameRecorder &)            = delete;
+        FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+        // path is the .y4m file or the directory of the raw frames
+        bool start(const std::string &path, FrameRecordFormat format, const FrameRecordSource &source, int fps = 30,
+                   ImGuiImageColorSpace colorSpace = ImGuiImageColorSpace_BT709);
+        // the queued frames are written before it returns
+        void stop();
+        bool isRecording() const { return mSession != nullptr; }
+
+        // render thread, once per frame
+        void update();
+
+        FrameRecorderStats getStats() const;
+        const std::string &getPath() const { return mPath; }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        std::shared_ptr<FrameRecordSession> mSession; // also held by the captures in flight
+        FrameRecordSource                   mSource;
+        std::string                         mPath;
+        Clock::duration                     mInterval;
+        Clock::time_point                   mNextCapture;
+        FrameRecorderStats                  mLastStats = {}; // of the stopped session
+    };
+
+} // namespace ImGui
+
+#endif
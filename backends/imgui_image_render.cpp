@@ -1,8 +1,26 @@
 
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include "imgui_image_render.h"
+#include "imgui_common_tools.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMGUI_IMAGE_CONVERT_X86
+    #include <emmintrin.h>
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define IMGUI_TARGET_AVX2
+    #else
+        #define IMGUI_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
 
 namespace ImGui
 {
@@ -88,9 +106,79 @@ namespace ImGui
                 *height        = imageHeight;
                 *bytesPerPixel = 1;
                 break;
+            case ImGuiImageFormat_P010:
+            case ImGuiImageFormat_P016:
+                if (plane == 0)
+                {
+                    *width         = imageWidth;
+                    *height        = imageHeight;
+                    *bytesPerPixel = 2;
+                }
+                else
+                {
+                    *width         = imageWidth / 2;
+                    *height        = imageHeight / 2;
+                    *bytesPerPixel = 4;
+                }
+                break;
+            case ImGuiImageFormat_YUV420P10LE:
+                if (plane == 0)
+                {
+                    *width  = imageWidth;
+                    *height = imageHeight;
+                }
+                else
+                {
+                    *width  = imageWidth / 2;
+                    *height = imageHeight / 2;
+                }
+                *bytesPerPixel = 2;
+                break;
+            case ImGuiImageFormat_Gray16:
+                *width         = imageWidth;
+                *height        = imageHeight;
+                *bytesPerPixel = 2;
+                break;
+            case ImGuiImageFormat_RGBA16:
+                *width         = imageWidth;
+                *height        = imageHeight;
+                *bytesPerPixel = 8;
+                break;
+            case ImGuiImageFormat_R32F:
+                *width         = imageWidth;
+                *height        = imageHeight;
+                *bytesPerPixel = 4;
+                break;
         }
         return 0;
     }
+    bool getImageDataROI(const ImageData &image, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                         ImageData &roi)
+    {
+        unsigned int planeCount = getPlaneCount(image.format);
+        if (planeCount <= 0 || width <= 0 || height <= 0 || x + width > image.width || y + height > image.height)
+            return false;
+
+        roi        = image;
+        roi.width  = width;
+        roi.height = height;
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            // plane size of a 4x2 image gives the subsampling of this plane
+            unsigned int bytesPerPixel = 0;
+            unsigned int planeWidth    = 0;
+            unsigned int planeHeight   = 0;
+            getPlaneInfo(image.format, 4, 2, i, &bytesPerPixel, &planeWidth, &planeHeight);
+            unsigned int subX = 4 / planeWidth;
+            unsigned int subY = 2 / planeHeight;
+            if (x % subX != 0 || y % subY != 0)
+                return false;
+
+            roi.plane[i] = image.plane[i] + (size_t)(y / subY) * image.stride[i] + (size_t)(x / subX) * bytesPerPixel;
+        }
+        return true;
+    }
+
     unsigned int getPlaneCount(ImGuiImageFormat format)
     {
 
@@ -103,9 +191,12 @@ namespace ImGui
             case ImGuiImageFormat_YUV411P:
             case ImGuiImageFormat_YUV420P:
             case ImGuiImageFormat_YV12:
+            case ImGuiImageFormat_YUV420P10LE:
                 return 3;
             case ImGuiImageFormat_NV12:
             case ImGuiImageFormat_NV21:
+            case ImGuiImageFormat_P010:
+            case ImGuiImageFormat_P016:
 #if IMGUI_RENDER_API == IMGUI_RENDER_API_DX11
             case ImGuiImageFormat_Dx11:
 #endif
@@ -113,16 +204,37 @@ namespace ImGui
             case ImGuiImageFormat_RGBA:
             case ImGuiImageFormat_BGRA:
             case ImGuiImageFormat_Gray:
+            case ImGuiImageFormat_Gray16:
+            case ImGuiImageFormat_RGBA16:
+            case ImGuiImageFormat_R32F:
                 return 1;
         }
     }
 
+    unsigned int getComponentBytes(ImGuiImageFormat format)
+    {
+        switch (format)
+        {
+            default:
+                return 1;
+            case ImGuiImageFormat_P010:
+            case ImGuiImageFormat_P016:
+            case ImGuiImageFormat_YUV420P10LE:
+            case ImGuiImageFormat_Gray16:
+            case ImGuiImageFormat_RGBA16:
+                return 2;
+            case ImGuiImageFormat_R32F:
+                return 4;
+        }
+    }
+
     int getTextureFormat(ImGuiImageFormat imageFormat)
     {
         switch (imageFormat)
         {
             default:
             case ImGuiImageFormat_RGBA:
+            case ImGuiImageFormat_RGBA16:
                 return TextureFormat_RGBA;
             case ImGuiImageFormat_BGRA:
                 return TextureFormat_BGRA;
@@ -130,70 +242,1111 @@ namespace ImGui
             case ImGuiImageFormat_YUV422P:
             case ImGuiImageFormat_YUV411P:
             case ImGuiImageFormat_YUV420P:
+            case ImGuiImageFormat_YUV420P10LE:
                 return TextureFormat_YUVPlaner;
             case ImGuiImageFormat_YV12:
                 return TextureFormat_YVUPlaner;
             case ImGuiImageFormat_NV12:
+            case ImGuiImageFormat_P010:
+            case ImGuiImageFormat_P016:
                 return TextureFormat_NV12;
             case ImGuiImageFormat_NV21:
                 return TextureFormat_NV21;
             case ImGuiImageFormat_Gray:
+            case ImGuiImageFormat_Gray16:
+            case ImGuiImageFormat_R32F:
                 return TextureFormat_Gray;
         }
     }
 
+    float getTextureValueScale(ImGuiImageFormat imageFormat)
+    {
+        // 10bit in the low bits of a 16bit component
+        if (imageFormat == ImGuiImageFormat_YUV420P10LE)
+            return 65535.f / 1023.f;
+        return 1.f;
+    }
+
+    void swapTextureSource(TextureSource &a, TextureSource &b)
+    {
+        std::swap(a.textureID, b.textureID);
+        std::swap(a.imageFormat, b.imageFormat);
+        std::swap(a.colorRange, b.colorRange);
+        std::swap(a.colorSpace, b.colorSpace);
+        std::swap(a.width, b.width);
+        std::swap(a.height, b.height);
+        std::swap(a.mipmaps, b.mipmaps);
+        std::swap(a.streaming, b.streaming);
+        std::swap(a.streamBuffer, b.streamBuffer);
+        std::swap(a.streamBufferSize, b.streamBufferSize);
+        std::swap(a.streamIndex, b.streamIndex);
+        std::swap(a.streamMapped, b.streamMapped);
+    }
+
     RenderSource::RenderSource(TextureSource &textureSource, ImGuiImageSampleType sampleType)
-        : imageFormat(textureSource.imageFormat), colorRange(textureSource.colorRange), width(textureSource.width),
-          height(textureSource.height), sampleType(sampleType)
+        : imageFormat(textureSource.imageFormat), colorRange(textureSource.colorRange), colorSpace(textureSource.colorSpace),
+          width(textureSource.width), height(textureSource.height), mipmaps(textureSource.mipmaps), sampleType(sampleType)
     {
         for (int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
             textureID[i] = textureSource.textureID[i];
     }
-    bool checkTextureRect(ImDrawVert vertices[6], ImVec2 &texturePos, ImVec2 &textureSize, ImVec2 &renderPos, ImVec2 &renderSize)
+    void addImageCommand(ImDrawList *drawList, RenderSource &source, const ImVec2 &pMin, const ImVec2 &pMax, const ImVec2 &uvMin,
+                         const ImVec2 &uvMax)
+    {
+        // the callback ends the current command, so the quad always starts the next one
+        drawList->AddCallback(ImDrawCallback_ImageCommand, &source);
+        drawList->AddImage((ImTextureID)(uintptr_t)&source, pMin, pMax, uvMin, uvMax);
+    }
+
+    bool needsImageShader(const RenderSource &source)
+    {
+        return source.imageFormat != ImGuiImageFormat_RGBA || source.sampleType != ImGuiImageSampleType_Linear
+            || source.mipmaps;
+    }
+
+    bool getImageCommandRect(const ImDrawList *drawList, const ImDrawCmd *pcmd, const RenderSource *source, ImVec2 &texturePos,
+                             ImVec2 &textureSize, ImVec2 &renderPos, ImVec2 &renderSize)
+    {
+        // anything merged into the command would be drawn with the image shader
+        if (!source || (RenderSource *)pcmd->GetTexID() != source || pcmd->ElemCount != 6)
+            return false;
+
+        // only the PrimRectUV() quad of AddImage(): indices a b c a c d, a the top left corner and c the bottom right
+        // one, b and d share their x/y. AddImageQuad(), rotated or rounded images are drawn as plain geometry
+        const ImDrawVert *vertices = drawList->VtxBuffer.Data + pcmd->VtxOffset;
+        const ImDrawIdx  *indices  = drawList->IdxBuffer.Data + pcmd->IdxOffset;
+        if (indices[1] != indices[0] + 1 || indices[2] != indices[0] + 2 || indices[3] != indices[0]
+            || indices[4] != indices[0] + 2 || indices[5] != indices[0] + 3)
+            return false;
+        const ImDrawVert &topLeft     = vertices[indices[0]];
+        const ImDrawVert &topRight    = vertices[indices[1]];
+        const ImDrawVert &bottomRight = vertices[indices[2]];
+        const ImDrawVert &bottomLeft  = vertices[indices[5]];
+        if (topRight.pos.x != bottomRight.pos.x || topRight.pos.y != topLeft.pos.y || bottomLeft.pos.x != topLeft.pos.x
+            || bottomLeft.pos.y != bottomRight.pos.y || topRight.uv.x != bottomRight.uv.x || topRight.uv.y != topLeft.uv.y
+            || bottomLeft.uv.x != topLeft.uv.x || bottomLeft.uv.y != bottomRight.uv.y)
+            return false;
+
+        texturePos  = topLeft.uv;
+        textureSize = bottomRight.uv - topLeft.uv;
+
+        renderPos  = topLeft.pos;
+        renderSize = bottomRight.pos - topLeft.pos;
+
+        return true;
+    }
+
+    // coefficients of yuvToRgb() in the shaders, scaled to 0~255
+    struct YuvCoefficients
+    {
+        float yOffset;
+        float uvOffset;
+        float yScale;
+        float vToR;
+        float uToG;
+        float vToG;
+        float uToB;
+    };
+
+    static YuvCoefficients getYuvCoefficients(ImGuiImageColorRange colorRange, ImGuiImageColorSpace colorSpace)
+    {
+        YuvCoefficients coef;
+        if (colorRange == ImGuiImageColorRange_16_235)
+        {
+            coef.yOffset  = 16.f;
+            coef.uvOffset = 128.f;
+        }
+        else
+        {
+            coef.yOffset  = 0.f;
+            coef.uvOffset = 127.5f;
+        }
+        coef.yScale = 1.164f;
+        switch (colorSpace)
+        {
+            default:
+            case ImGuiImageColorSpace_BT601:
+                coef.vToR = 1.596f;
+                coef.uToG = -0.39465f;
+                coef.vToG = -0.81300f;
+                coef.uToB = 2.03211f;
+                break;
+            case ImGuiImageColorSpace_BT709:
+                coef.vToR = 1.793f;
+                coef.uToG = -0.213f;
+                coef.vToG = -0.533f;
+                coef.uToB = 2.112f;
+                break;
+            case ImGuiImageColorSpace_BT2020:
+                coef.vToR = 1.678f;
+                coef.uToG = -0.1873f;
+                coef.vToG = -0.6504f;
+                coef.uToB = 2.1418f;
+                break;
+        }
+        return coef;
+    }
+
+    static inline uint8_t clampToByte(float value)
+    {
+        int v = (int)(value + 0.5f);
+        return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    // rgb to yuv of the encoders, 0~255 in and out, offsets included
+    struct RgbCoefficients
     {
-        std::vector<ImDrawVert> vertSet;
-        for (int i = 0; i < 6; i++)
+        float yR, yG, yB, yOffset;
+        float uR, uG, uB;
+        float vR, vG, vB, uvOffset;
+    };
+
+    static RgbCoefficients getRgbCoefficients(ImGuiImageColorRange colorRange, ImGuiImageColorSpace colorSpace)
+    {
+        float kr = 0.299f, kb = 0.114f;
+        if (colorSpace == ImGuiImageColorSpace_BT709)
         {
-            bool found = false;
-            for (auto &uv : vertSet)
+            kr = 0.2126f;
+            kb = 0.0722f;
+        }
+        else if (colorSpace == ImGuiImageColorSpace_BT2020)
+        {
+            kr = 0.2627f;
+            kb = 0.0593f;
+        }
+        float kg = 1.f - kr - kb;
+
+        bool  limited = colorRange == ImGuiImageColorRange_16_235;
+        float yScale  = limited ? 219.f / 255.f : 1.f;
+        float uvScale = limited ? 224.f / 255.f : 1.f;
+
+        RgbCoefficients coef;
+        coef.yR       = kr * yScale;
+        coef.yG       = kg * yScale;
+        coef.yB       = kb * yScale;
+        coef.yOffset  = limited ? 16.f : 0.f;
+        coef.uR       = -kr / (2.f * (1.f - kb)) * uvScale;
+        coef.uG       = -kg / (2.f * (1.f - kb)) * uvScale;
+        coef.uB       = 0.5f * uvScale;
+        coef.vR       = 0.5f * uvScale;
+        coef.vG       = -kg / (2.f * (1.f - kr)) * uvScale;
+        coef.vB       = -kb / (2.f * (1.f - kr)) * uvScale;
+        coef.uvOffset = 128.f;
+        return coef;
+    }
+
+    typedef void (*YuvRowFunc)(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, unsigned int width,
+                               const YuvCoefficients &coef);
+    typedef void (*PackedRowFunc)(const uint8_t *src, uint8_t *dst, unsigned int width);
+    // two RGBA rows to two luma rows and one row of each chroma plane, width is even
+    typedef void (*I420RowFunc)(const uint8_t *src0, const uint8_t *src1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v,
+                                unsigned int width, const RgbCoefficients &coef);
+
+    static void yuvRowToRGBA_C(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, unsigned int width,
+                               const YuvCoefficients &coef)
+    {
+        for (unsigned int x = 0; x < width; x++)
+        {
+            float fy = (y[x] - coef.yOffset) * coef.yScale;
+            float fu = u[x] - coef.uvOffset;
+            float fv = v[x] - coef.uvOffset;
+
+            dst[x * 4 + 0] = clampToByte(fy + coef.vToR * fv);
+            dst[x * 4 + 1] = clampToByte(fy + coef.uToG * fu + coef.vToG * fv);
+            dst[x * 4 + 2] = clampToByte(fy + coef.uToB * fu);
+            dst[x * 4 + 3] = 255;
+        }
+    }
+    static void swapRBRow_C(const uint8_t *src, uint8_t *dst, unsigned int width)
+    {
+        for (unsigned int x = 0; x < width; x++)
+        {
+            uint8_t r      = src[x * 4 + 0];
+            dst[x * 4 + 0] = src[x * 4 + 2];
+            dst[x * 4 + 1] = src[x * 4 + 1];
+            dst[x * 4 + 2] = r;
+            dst[x * 4 + 3] = src[x * 4 + 3];
+        }
+    }
+    static void grayRowToRGBA_C(const uint8_t *src, uint8_t *dst, unsigned int width)
+    {
+        for (unsigned int x = 0; x < width; x++)
+        {
+            dst[x * 4 + 0] = src[x];
+            dst[x * 4 + 1] = src[x];
+            dst[x * 4 + 2] = src[x];
+            dst[x * 4 + 3] = 255;
+        }
+    }
+    static void rgbaRowsToI420_C(const uint8_t *src0, const uint8_t *src1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v,
+                                 unsigned int width, const RgbCoefficients &coef)
+    {
+        for (unsigned int x = 0; x < width; x += 2)
+        {
+            const uint8_t *p[4] = {src0 + x * 4, src0 + x * 4 + 4, src1 + x * 4, src1 + x * 4 + 4};
+            float          r = 0, g = 0, b = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                uint8_t luma = clampToByte(coef.yOffset + coef.yR * p[i][0] + coef.yG * p[i][1] + coef.yB * p[i][2]);
+                if (i < 2)
+                    y0[x + i] = luma;
+                else
+                    y1[x + i - 2] = luma;
+                r += p[i][0];
+                g += p[i][1];
+                b += p[i][2];
+            }
+            r *= 0.25f;
+            g *= 0.25f;
+            b *= 0.25f;
+            u[x / 2] = clampToByte(coef.uvOffset + coef.uR * r + coef.uG * g + coef.uB * b);
+            v[x / 2] = clampToByte(coef.uvOffset + coef.vR * r + coef.vG * g + coef.vB * b);
+        }
+    }
+
+#ifdef IMGUI_IMAGE_CONVERT_X86
+    // interleave 8 pixels of 16bit r/g/b into RGBA8888
+    static inline void storeRGBA8(__m128i r16, __m128i g16, __m128i b16, uint8_t *dst)
+    {
+        __m128i r8   = _mm_packus_epi16(r16, r16);
+        __m128i g8   = _mm_packus_epi16(g16, g16);
+        __m128i b8   = _mm_packus_epi16(b16, b16);
+        __m128i rg   = _mm_unpacklo_epi8(r8, g8);
+        __m128i ba   = _mm_unpacklo_epi8(b8, _mm_set1_epi8((char)0xff));
+        __m128i *out = (__m128i *)dst;
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg, ba));
+    }
+
+    static void yuvRowToRGBA_SSE2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, unsigned int width,
+                                  const YuvCoefficients &coef)
+    {
+        const __m128i zero     = _mm_setzero_si128();
+        const __m128  yOffset  = _mm_set1_ps(coef.yOffset);
+        const __m128  uvOffset = _mm_set1_ps(coef.uvOffset);
+        const __m128  yScale   = _mm_set1_ps(coef.yScale);
+        const __m128  vToR     = _mm_set1_ps(coef.vToR);
+        const __m128  uToG     = _mm_set1_ps(coef.uToG);
+        const __m128  vToG     = _mm_set1_ps(coef.vToG);
+        const __m128  uToB     = _mm_set1_ps(coef.uToB);
+
+        unsigned int x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(y + x)), zero);
+            __m128i u16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(u + x)), zero);
+            __m128i v16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(v + x)), zero);
+
+            __m128i rgb[3][2];
+            for (int half = 0; half < 2; half++)
+            {
+                __m128i y32 = half ? _mm_unpackhi_epi16(y16, zero) : _mm_unpacklo_epi16(y16, zero);
+                __m128i u32 = half ? _mm_unpackhi_epi16(u16, zero) : _mm_unpacklo_epi16(u16, zero);
+                __m128i v32 = half ? _mm_unpackhi_epi16(v16, zero) : _mm_unpacklo_epi16(v16, zero);
+
+                __m128 fy = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(y32), yOffset), yScale);
+                __m128 fu = _mm_sub_ps(_mm_cvtepi32_ps(u32), uvOffset);
+                __m128 fv = _mm_sub_ps(_mm_cvtepi32_ps(v32), uvOffset);
+
+                rgb[0][half] = _mm_cvtps_epi32(_mm_add_ps(fy, _mm_mul_ps(vToR, fv)));
+                rgb[1][half] = _mm_cvtps_epi32(_mm_add_ps(fy, _mm_add_ps(_mm_mul_ps(uToG, fu), _mm_mul_ps(vToG, fv))));
+                rgb[2][half] = _mm_cvtps_epi32(_mm_add_ps(fy, _mm_mul_ps(uToB, fu)));
+            }
+            storeRGBA8(_mm_packs_epi32(rgb[0][0], rgb[0][1]), _mm_packs_epi32(rgb[1][0], rgb[1][1]),
+                       _mm_packs_epi32(rgb[2][0], rgb[2][1]), dst + x * 4);
+        }
+        yuvRowToRGBA_C(y + x, u + x, v + x, dst + x * 4, width - x, coef);
+    }
+    static void swapRBRow_SSE2(const uint8_t *src, uint8_t *dst, unsigned int width)
+    {
+        const __m128i ga = _mm_set1_epi32((int)0xff00ff00);
+        const __m128i lo = _mm_set1_epi32(0x000000ff);
+
+        unsigned int x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i px = _mm_loadu_si128((const __m128i *)(src + x * 4));
+            __m128i rb = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(px, 16), lo), _mm_slli_epi32(_mm_and_si128(px, lo), 16));
+            _mm_storeu_si128((__m128i *)(dst + x * 4), _mm_or_si128(_mm_and_si128(px, ga), rb));
+        }
+        swapRBRow_C(src + x * 4, dst + x * 4, width - x);
+    }
+    static void grayRowToRGBA_SSE2(const uint8_t *src, uint8_t *dst, unsigned int width)
+    {
+        const __m128i alpha = _mm_set1_epi8((char)0xff);
+
+        unsigned int x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i gray = _mm_loadu_si128((const __m128i *)(src + x));
+            __m128i lo   = _mm_unpacklo_epi8(gray, gray);
+            __m128i hi   = _mm_unpackhi_epi8(gray, gray);
+            __m128i loA  = _mm_unpacklo_epi8(gray, alpha);
+            __m128i hiA  = _mm_unpackhi_epi8(gray, alpha);
+            __m128i *out = (__m128i *)(dst + x * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, loA));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, loA));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, hiA));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, hiA));
+        }
+        grayRowToRGBA_C(src + x, dst + x * 4, width - x);
+    }
+
+    // r/g/b of 4 RGBA pixels as floats
+    static inline void loadRGB4(const uint8_t *src, __m128 &r, __m128 &g, __m128 &b)
+    {
+        const __m128i mask = _mm_set1_epi32(0xff);
+        __m128i       px   = _mm_loadu_si128((const __m128i *)src);
+        r                  = _mm_cvtepi32_ps(_mm_and_si128(px, mask));
+        g                  = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 8), mask));
+        b                  = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, 16), mask));
+    }
+
+    static inline __m128i dotRGB(__m128 r, __m128 g, __m128 b, __m128 cr, __m128 cg, __m128 cb, __m128 offset)
+    {
+        return _mm_cvtps_epi32(_mm_add_ps(offset, _mm_add_ps(_mm_mul_ps(cr, r), _mm_add_ps(_mm_mul_ps(cg, g), _mm_mul_ps(cb, b)))));
+    }
+
+    static void rgbaRowsToI420_SSE2(const uint8_t *src0, const uint8_t *src1, uint8_t *y0, uint8_t *y1, uint8_t *u, uint8_t *v,
+                                    unsigned int width, const RgbCoefficients &coef)
+    {
+        const __m128 yR       = _mm_set1_ps(coef.yR);
+        const __m128 yG       = _mm_set1_ps(coef.yG);
+        const __m128 yB       = _mm_set1_ps(coef.yB);
+        const __m128 yOffset  = _mm_set1_ps(coef.yOffset);
+        const __m128 uR       = _mm_set1_ps(coef.uR);
+        const __m128 uG       = _mm_set1_ps(coef.uG);
+        const __m128 uB       = _mm_set1_ps(coef.uB);
+        const __m128 vR       = _mm_set1_ps(coef.vR);
+        const __m128 vG       = _mm_set1_ps(coef.vG);
+        const __m128 vB       = _mm_set1_ps(coef.vB);
+        const __m128 uvOffset = _mm_set1_ps(coef.uvOffset);
+        const __m128 quarter  = _mm_set1_ps(0.25f);
+
+        unsigned int x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            // [row][half] of 4 pixels
+            __m128 r[2][2], g[2][2], b[2][2];
+            loadRGB4(src0 + x * 4, r[0][0], g[0][0], b[0][0]);
+            loadRGB4(src0 + x * 4 + 16, r[0][1], g[0][1], b[0][1]);
+            loadRGB4(src1 + x * 4, r[1][0], g[1][0], b[1][0]);
+            loadRGB4(src1 + x * 4 + 16, r[1][1], g[1][1], b[1][1]);
+
+            uint8_t *yDst[2] = {y0 + x, y1 + x};
+            for (int row = 0; row < 2; row++)
+            {
+                __m128i lo = dotRGB(r[row][0], g[row][0], b[row][0], yR, yG, yB, yOffset);
+                __m128i hi = dotRGB(r[row][1], g[row][1], b[row][1], yR, yG, yB, yOffset);
+                __m128i y8 = _mm_packus_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128());
+                _mm_storel_epi64((__m128i *)yDst[row], y8);
+            }
+
+            // sum the two rows, then the pixel pairs: even + odd lanes of both halves
+            __m128 sum[3][2];
+            for (int half = 0; half < 2; half++)
+            {
+                sum[0][half] = _mm_add_ps(r[0][half], r[1][half]);
+                sum[1][half] = _mm_add_ps(g[0][half], g[1][half]);
+                sum[2][half] = _mm_add_ps(b[0][half], b[1][half]);
+            }
+            __m128 avg[3];
+            for (int c = 0; c < 3; c++)
             {
-                if (uv.uv == vertices[i].uv)
-                    found = true;
+                __m128 even = _mm_shuffle_ps(sum[c][0], sum[c][1], _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 odd  = _mm_shuffle_ps(sum[c][0], sum[c][1], _MM_SHUFFLE(3, 1, 3, 1));
+                avg[c]      = _mm_mul_ps(_mm_add_ps(even, odd), quarter);
             }
-            if (!found)
-                vertSet.push_back(vertices[i]);
+
+            __m128i u32 = dotRGB(avg[0], avg[1], avg[2], uR, uG, uB, uvOffset);
+            __m128i v32 = dotRGB(avg[0], avg[1], avg[2], vR, vG, vB, uvOffset);
+            __m128i uv8 = _mm_packus_epi16(_mm_packs_epi32(u32, v32), _mm_setzero_si128());
+            int     u4  = _mm_cvtsi128_si32(uv8);
+            int     v4  = _mm_cvtsi128_si32(_mm_srli_si128(uv8, 4));
+            memcpy(u + x / 2, &u4, 4);
+            memcpy(v + x / 2, &v4, 4);
+        }
+        rgbaRowsToI420_C(src0 + x * 4, src1 + x * 4, y0 + x, y1 + x, u + x / 2, v + x / 2, width - x, coef);
+    }
+
+    IMGUI_TARGET_AVX2
+    static void yuvRowToRGBA_AVX2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, unsigned int width,
+                                  const YuvCoefficients &coef)
+    {
+        const __m256 yOffset  = _mm256_set1_ps(coef.yOffset);
+        const __m256 uvOffset = _mm256_set1_ps(coef.uvOffset);
+        const __m256 yScale   = _mm256_set1_ps(coef.yScale);
+        const __m256 vToR     = _mm256_set1_ps(coef.vToR);
+        const __m256 uToG     = _mm256_set1_ps(coef.uToG);
+        const __m256 vToG     = _mm256_set1_ps(coef.vToG);
+        const __m256 uToB     = _mm256_set1_ps(coef.uToB);
+
+        unsigned int x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256 fy = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(y + x))));
+            __m256 fu = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(u + x))));
+            __m256 fv = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(v + x))));
+            fy        = _mm256_mul_ps(_mm256_sub_ps(fy, yOffset), yScale);
+            fu        = _mm256_sub_ps(fu, uvOffset);
+            fv        = _mm256_sub_ps(fv, uvOffset);
+
+            __m256i r = _mm256_cvtps_epi32(_mm256_add_ps(fy, _mm256_mul_ps(vToR, fv)));
+            __m256i g = _mm256_cvtps_epi32(_mm256_add_ps(fy, _mm256_add_ps(_mm256_mul_ps(uToG, fu), _mm256_mul_ps(vToG, fv))));
+            __m256i b = _mm256_cvtps_epi32(_mm256_add_ps(fy, _mm256_mul_ps(uToB, fu)));
+
+            // 256bit packs works per lane, pack the halves with sse to keep the pixel order
+            storeRGBA8(_mm_packs_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1)),
+                       _mm_packs_epi32(_mm256_castsi256_si128(g), _mm256_extracti128_si256(g, 1)),
+                       _mm_packs_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1)), dst + x * 4);
+        }
+        yuvRowToRGBA_C(y + x, u + x, v + x, dst + x * 4, width - x, coef);
+    }
+    IMGUI_TARGET_AVX2
+    static void swapRBRow_AVX2(const uint8_t *src, uint8_t *dst, unsigned int width)
+    {
+        const __m256i ga = _mm256_set1_epi32((int)0xff00ff00);
+        const __m256i lo = _mm256_set1_epi32(0x000000ff);
+
+        unsigned int x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256i px = _mm256_loadu_si256((const __m256i *)(src + x * 4));
+            __m256i rb = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(px, 16), lo),
+                                         _mm256_slli_epi32(_mm256_and_si256(px, lo), 16));
+            _mm256_storeu_si256((__m256i *)(dst + x * 4), _mm256_or_si256(_mm256_and_si256(px, ga), rb));
         }
+        swapRBRow_C(src + x * 4, dst + x * 4, width - x);
+    }
 
-        if (vertSet.size() != 4)
+    static bool cpuSupportsAVX2()
+    {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        // avx and osxsave, and the os saves the ymm registers
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
             return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+#endif
 
-        ImVec2 topLeft           = vertSet.begin()->uv;
-        ImVec2 renderTopLeft     = vertSet.begin()->pos;
-        ImVec2 bottomRight       = vertSet.begin()->uv;
-        ImVec2 renderBottomRight = vertSet.begin()->pos;
+    struct ConvertKernels
+    {
+        ImGuiImageConvertKernel kernel    = ImGuiImageConvertKernel_C;
+        YuvRowFunc              yuvRow    = yuvRowToRGBA_C;
+        PackedRowFunc           swapRBRow = swapRBRow_C;
+        PackedRowFunc           grayRow   = grayRowToRGBA_C;
+        I420RowFunc             i420Rows  = rgbaRowsToI420_C;
+    };
 
-        for (auto vert : vertSet)
+    // the best kernels up to maxKernel the cpu supports
+    static ConvertKernels makeConvertKernels(ImGuiImageConvertKernel maxKernel)
+    {
+        ConvertKernels k;
+#ifdef IMGUI_IMAGE_CONVERT_X86
+        if (maxKernel >= ImGuiImageConvertKernel_SSE2)
+        {
+            k.kernel    = ImGuiImageConvertKernel_SSE2;
+            k.yuvRow    = yuvRowToRGBA_SSE2;
+            k.swapRBRow = swapRBRow_SSE2;
+            k.grayRow   = grayRowToRGBA_SSE2;
+            k.i420Rows  = rgbaRowsToI420_SSE2;
+        }
+        if (maxKernel >= ImGuiImageConvertKernel_AVX2 && cpuSupportsAVX2())
         {
-            if (vert.uv.x < topLeft.x || vert.uv.y < topLeft.y)
-                topLeft = vert.uv;
+            k.kernel    = ImGuiImageConvertKernel_AVX2;
+            k.yuvRow    = yuvRowToRGBA_AVX2;
+            k.swapRBRow = swapRBRow_AVX2;
+        }
+#else
+        IM_UNUSED(maxKernel);
+#endif
+        return k;
+    }
 
-            if (vert.pos.x < renderTopLeft.x || vert.pos.y < renderTopLeft.y)
-                renderTopLeft = vert.pos;
+    static ConvertKernels &getConvertKernels()
+    {
+        static ConvertKernels kernels = makeConvertKernels(ImGuiImageConvertKernel_AVX2);
+        return kernels;
+    }
 
-            if (vert.uv.x > bottomRight.x || vert.uv.y > bottomRight.y)
-                bottomRight = vert.uv;
+    bool setImageConvertKernel(ImGuiImageConvertKernel kernel)
+    {
+        if (kernel < 0 || kernel >= ImGuiImageConvertKernel_Max)
+            return false;
+        getConvertKernels() = makeConvertKernels(kernel);
+        return getConvertKernels().kernel == kernel;
+    }
+
+    ImGuiImageConvertKernel getImageConvertKernel()
+    {
+        return getConvertKernels().kernel;
+    }
+
+    // expand one chroma row to full width, step is 2 for the interleaved uv plane
+    static void upsampleChromaRow(const uint8_t *src, unsigned int step, unsigned int subX, unsigned int chromaWidth,
+                                  uint8_t *dst, unsigned int width)
+    {
+        if (chromaWidth == 0)
+            chromaWidth = 1;
+        unsigned int x = 0;
+        for (unsigned int cx = 0; x < width; cx++)
+        {
+            uint8_t value = src[MIN(cx, chromaWidth - 1) * step];
+            for (unsigned int i = 0; i < subX && x < width; i++)
+                dst[x++] = value;
+        }
+    }
+
+    // 8bit format with the same layout
+    static ImGuiImageFormat getNarrowFormat(ImGuiImageFormat format)
+    {
+        switch (format)
+        {
+            default:
+                return ImGuiImageFormat_None;
+            case ImGuiImageFormat_P010:
+            case ImGuiImageFormat_P016:
+                return ImGuiImageFormat_NV12;
+            case ImGuiImageFormat_YUV420P10LE:
+                return ImGuiImageFormat_YUV420P;
+            case ImGuiImageFormat_Gray16:
+            case ImGuiImageFormat_R32F:
+                return ImGuiImageFormat_Gray;
+            case ImGuiImageFormat_RGBA16:
+                return ImGuiImageFormat_RGBA;
+        }
+    }
+
+    static void narrowRow(ImGuiImageFormat format, const uint8_t *src, uint8_t *dst, unsigned int count)
+    {
+        switch (format)
+        {
+            default:
+                // little endian 16bit using all bits, keep the high byte
+                for (unsigned int i = 0; i < count; i++)
+                    dst[i] = src[i * 2 + 1];
+                break;
+            case ImGuiImageFormat_YUV420P10LE:
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    unsigned int value = src[i * 2] | (src[i * 2 + 1] << 8);
+                    dst[i]             = (uint8_t)MIN(value >> 2, 255u);
+                }
+                break;
+            case ImGuiImageFormat_R32F:
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    float value;
+                    memcpy(&value, src + i * 4, sizeof(value));
+                    dst[i] = clampToByte(value * 255.f);
+                }
+                break;
+        }
+    }
+
+    static void convertRowsToRGBA(const ImageData &image, uint8_t *dst, unsigned int dstStride, unsigned int rowBegin,
+                                  unsigned int rowEnd);
+
+    // narrow every row to the 8bit format of the same layout, then convert it as a one row image
+    static void convertDeepRowsToRGBA(const ImageData &image, uint8_t *dst, unsigned int dstStride, unsigned int rowBegin,
+                                      unsigned int rowEnd)
+    {
+        ImageData narrow = image;
+        narrow.format    = getNarrowFormat(image.format);
+        narrow.height    = 1;
+
+        unsigned int planeCount                          = getPlaneCount(image.format);
+        unsigned int componentBytes                      = getComponentBytes(image.format);
+        unsigned int subY[IMGUI_IMAGE_MAX_PLANES]        = {0};
+        unsigned int planeHeight[IMGUI_IMAGE_MAX_PLANES] = {0};
+        size_t       offset[IMGUI_IMAGE_MAX_PLANES]      = {0};
+        size_t       totalSize                           = 0;
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(image.format, 4, 2, i, &bytesPerPixel, &width, &height);
+            subY[i] = 2 / height;
+            getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &planeHeight[i]);
+            narrow.stride[i] = width * bytesPerPixel / componentBytes;
+            offset[i]        = totalSize;
+            totalSize += narrow.stride[i];
+        }
+        std::vector<uint8_t> rows(totalSize);
+
+        for (unsigned int row = rowBegin; row < rowEnd; row++)
+        {
+            for (unsigned int i = 0; i < planeCount; i++)
+            {
+                unsigned int srcRow = MIN(row / subY[i], planeHeight[i] ? planeHeight[i] - 1 : 0);
+                narrow.plane[i]     = rows.data() + offset[i];
+                narrowRow(image.format, image.plane[i] + (size_t)srcRow * image.stride[i], narrow.plane[i], narrow.stride[i]);
+            }
+            convertRowsToRGBA(narrow, dst + (size_t)row * dstStride, dstStride, 0, 1);
+        }
+    }
+
+    static void convertRowsToRGBA(const ImageData &image, uint8_t *dst, unsigned int dstStride, unsigned int rowBegin,
+                                  unsigned int rowEnd)
+    {
+        const ConvertKernels &kernels = getConvertKernels();
+
+        unsigned int width = image.width;
+        switch (image.format)
+        {
+            default:
+                return;
+            case ImGuiImageFormat_RGBA:
+                for (unsigned int row = rowBegin; row < rowEnd; row++)
+                    memcpy(dst + (size_t)row * dstStride, image.plane[0] + (size_t)row * image.stride[0], (size_t)width * 4);
+                return;
+            case ImGuiImageFormat_BGRA:
+                for (unsigned int row = rowBegin; row < rowEnd; row++)
+                    kernels.swapRBRow(image.plane[0] + (size_t)row * image.stride[0], dst + (size_t)row * dstStride, width);
+                return;
+            case ImGuiImageFormat_Gray:
+                for (unsigned int row = rowBegin; row < rowEnd; row++)
+                    kernels.grayRow(image.plane[0] + (size_t)row * image.stride[0], dst + (size_t)row * dstStride, width);
+                return;
+            case ImGuiImageFormat_YUV444P:
+            case ImGuiImageFormat_YUV422P:
+            case ImGuiImageFormat_YUV411P:
+            case ImGuiImageFormat_YUV420P:
+            case ImGuiImageFormat_YV12:
+            case ImGuiImageFormat_NV12:
+            case ImGuiImageFormat_NV21:
+                break;
+            case ImGuiImageFormat_P010:
+            case ImGuiImageFormat_P016:
+            case ImGuiImageFormat_YUV420P10LE:
+            case ImGuiImageFormat_Gray16:
+            case ImGuiImageFormat_RGBA16:
+            case ImGuiImageFormat_R32F:
+                convertDeepRowsToRGBA(image, dst, dstStride, rowBegin, rowEnd);
+                return;
+        }
+
+        // plane size of a 4x2 image gives the subsampling, see getImageDataROI()
+        unsigned int bytesPerPixel = 0;
+        unsigned int chromaWidth   = 0;
+        unsigned int chromaHeight  = 0;
+        getPlaneInfo(image.format, 4, 2, 1, &bytesPerPixel, &chromaWidth, &chromaHeight);
+        unsigned int subX = 4 / chromaWidth;
+        unsigned int subY = 2 / chromaHeight;
+        getPlaneInfo(image.format, image.width, image.height, 1, &bytesPerPixel, &chromaWidth, &chromaHeight);
+
+        bool         interleaved = (image.format == ImGuiImageFormat_NV12 || image.format == ImGuiImageFormat_NV21);
+        unsigned int uPlane      = (image.format == ImGuiImageFormat_YV12) ? 2 : 1;
+        unsigned int vPlane      = (image.format == ImGuiImageFormat_YV12) ? 1 : 2;
+        unsigned int uOffset     = (image.format == ImGuiImageFormat_NV21) ? 1 : 0;
+
+        YuvCoefficients      coef = getYuvCoefficients(image.colorRange, image.colorSpace);
+        std::vector<uint8_t> chromaRow(subX == 1 && !interleaved ? 0 : (size_t)width * 2);
+
+        for (unsigned int row = rowBegin; row < rowEnd; row++)
+        {
+            const uint8_t *y = image.plane[0] + (size_t)row * image.stride[0];
+            const uint8_t *u = nullptr;
+            const uint8_t *v = nullptr;
+
+            unsigned int chromaY = MIN(row / subY, chromaHeight ? chromaHeight - 1 : 0);
+            if (interleaved)
+            {
+                const uint8_t *uv = image.plane[1] + (size_t)chromaY * image.stride[1];
+                upsampleChromaRow(uv + uOffset, 2, subX, chromaWidth, chromaRow.data(), width);
+                upsampleChromaRow(uv + (1 - uOffset), 2, subX, chromaWidth, chromaRow.data() + width, width);
+                u = chromaRow.data();
+                v = chromaRow.data() + width;
+            }
+            else
+            {
+                u = image.plane[uPlane] + (size_t)chromaY * image.stride[uPlane];
+                v = image.plane[vPlane] + (size_t)chromaY * image.stride[vPlane];
+                if (subX != 1)
+                {
+                    upsampleChromaRow(u, 1, subX, chromaWidth, chromaRow.data(), width);
+                    upsampleChromaRow(v, 1, subX, chromaWidth, chromaRow.data() + width, width);
+                    u = chromaRow.data();
+                    v = chromaRow.data() + width;
+                }
+            }
+            kernels.yuvRow(y, u, v, dst + (size_t)row * dstStride, width, coef);
+        }
+    }
+
+    bool convertImageToRGBA(const ImageData &image, uint8_t *dst, unsigned int dstStride)
+    {
+        if (!dst || INVALID_IMAGE_FORMAT(image.format) || image.width <= 0 || image.height <= 0)
+            return false;
+        unsigned int planeCount = getPlaneCount(image.format);
+        if (planeCount == 0)
+            return false;
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            if (!image.plane[i])
+                return false;
+        }
+        if (dstStride == 0)
+            dstStride = image.width * 4;
+        if (dstStride < image.width * 4)
+            return false;
+
+        // below about 1MPix handing bands to the workers costs more than it saves
+        const unsigned int minRowsPerBand = 64;
+        unsigned int       bandCount      = 1;
+        if ((size_t)image.width * image.height >= 1024 * 1024)
+        {
+            bandCount = MAX(std::thread::hardware_concurrency(), 1u);
+            bandCount = MIN(bandCount, 8u);
+            bandCount = MIN(bandCount, image.height / minRowsPerBand);
+            bandCount = MAX(bandCount, 1u);
+        }
+
+        // keep bands on chroma row boundaries
+        unsigned int rowsPerBand = (image.height + bandCount - 1) / bandCount;
+        rowsPerBand              = (rowsPerBand + 1) & ~1u;
+
+        runParallel(bandCount,
+                    [&](unsigned int band)
+                    {
+                        unsigned int rowBegin = band * rowsPerBand;
+                        unsigned int rowEnd   = MIN(rowBegin + rowsPerBand, image.height);
+                        if (rowBegin < rowEnd)
+                            convertRowsToRGBA(image, dst, dstStride, rowBegin, rowEnd);
+                    });
+
+        return true;
+    }
+
+    bool convertRGBAToI420(const uint8_t *src, unsigned int srcStride, ImageData &dst)
+    {
+        if (!src || dst.format != ImGuiImageFormat_YUV420P || dst.width == 0 || dst.height == 0 || dst.width % 2 != 0
+            || dst.height % 2 != 0 || !dst.plane[0] || !dst.plane[1] || !dst.plane[2])
+            return false;
+        if (srcStride == 0)
+            srcStride = dst.width * 4;
+
+        const ConvertKernels &kernels = getConvertKernels();
+        RgbCoefficients       coef    = getRgbCoefficients(dst.colorRange, dst.colorSpace);
+        for (unsigned int row = 0; row < dst.height; row += 2)
+        {
+            const uint8_t *src0 = src + (size_t)row * srcStride;
+            kernels.i420Rows(src0, src0 + srcStride, dst.plane[0] + (size_t)row * dst.stride[0],
+                             dst.plane[0] + (size_t)(row + 1) * dst.stride[0], dst.plane[1] + (size_t)(row / 2) * dst.stride[1],
+                             dst.plane[2] + (size_t)(row / 2) * dst.stride[2], dst.width, coef);
+        }
+        return true;
+    }
+
+    static StdMutex                     gTextureStreamsLock;
+    static std::vector<TextureStream *> gTextureStreams;
+
+    TextureStream::TextureStream()
+    {
+        StdMutexGuard lock(gTextureStreamsLock);
+        gTextureStreams.push_back(this);
+    }
+    TextureStream::~TextureStream()
+    {
+        StdMutexGuard lock(gTextureStreamsLock);
+        gTextureStreams.erase(std::remove(gTextureStreams.begin(), gTextureStreams.end(), this), gTextureStreams.end());
+    }
+
+    void TextureStream::submit(ImageData &&image)
+    {
+        ImageData dropped = {};
+        {
+            StdMutexGuard lock(mLock);
+            if (mHasPending)
+            {
+                dropped = std::move(mPending);
+                mDroppedCount++;
+            }
+            mPending    = std::move(image);
+            mHasPending = true;
+            mSubmittedCount++;
+        }
+        // memory of the dropped frame is released out of the lock
+        requestRedraw();
+    }
+
+    bool TextureStream::update()
+    {
+        ImageData image = {};
+        {
+            StdMutexGuard lock(mLock);
+            if (!mHasPending)
+                return false;
+            image       = std::move(mPending);
+            mPending    = {};
+            mHasPending = false;
+        }
+        return updateImageTexture(image, mTexture);
+    }
+
+    uint64_t TextureStream::submittedFrames()
+    {
+        StdMutexGuard lock(mLock);
+        return mSubmittedCount;
+    }
+    uint64_t TextureStream::droppedFrames()
+    {
+        StdMutexGuard lock(mLock);
+        return mDroppedCount;
+    }
+
+    void updateTextureStreams()
+    {
+        StdMutexGuard lock(gTextureStreamsLock);
+        for (auto stream : gTextureStreams)
+            stream->update();
+    }
+
+    // average taps x taps samples for every component of a row, T is the type of a component
+    template <typename T, typename Sum>
+    static void averageTapsRow(const uint8_t *const *srcRows, const unsigned int *columns, unsigned int taps,
+                               unsigned int components, unsigned int width, uint8_t *dst)
+    {
+        Sum count = (Sum)(taps * taps);
+        T  *out   = (T *)dst;
+        for (unsigned int x = 0; x < width; x++)
+        {
+            for (unsigned int c = 0; c < components; c++)
+            {
+                Sum sum = 0;
+                for (unsigned int ty = 0; ty < taps; ty++)
+                {
+                    const T *row = (const T *)srcRows[ty];
+                    for (unsigned int tx = 0; tx < taps; tx++)
+                        sum += row[columns[x * taps + tx] * components + c];
+                }
+                if constexpr (std::is_floating_point<T>::value)
+                    out[x * components + c] = sum / count;
+                else
+                    out[x * components + c] = (T)((sum + count / 2) / count);
+            }
+        }
+    }
+
+    TiledImage::TiledImage(unsigned int tileSize, unsigned int residentTiles)
+        : mTileSize((MAX(tileSize, 4u) + 3) & ~3u), mResidentLimit(residentTiles)
+    {
+    }
+
+    bool TiledImage::setImage(const ImageData &image)
+    {
+        clear();
+        unsigned int planeCount = getPlaneCount(image.format);
+        if (planeCount == 0 || image.width <= 0 || image.height <= 0)
+            return false;
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            if (!image.plane[i])
+                return false;
+        }
+
+        mImage = image;
+        // the coarsest level fits in one tile
+        mMaxLevel = 0;
+        while ((MAX(mImage.width, mImage.height) >> mMaxLevel) > mTileSize)
+            mMaxLevel++;
+        return true;
+    }
 
-            if (vert.pos.x > renderBottomRight.x || vert.pos.y > renderBottomRight.y)
-                renderBottomRight = vert.pos;
+    void TiledImage::clear()
+    {
+        mTiles.clear();
+        mVisible.clear();
+        mImage    = {};
+        mMaxLevel = 0;
+    }
+
+    unsigned int TiledImage::getLevel(float pixelScale) const
+    {
+        // coarsest level whose pixels are still drawn at least one screen pixel large
+        unsigned int level = 0;
+        while (level < mMaxLevel && (float)(1u << (level + 1)) * pixelScale <= 1.f)
+            level++;
+        return level;
+    }
+
+    const std::vector<TiledImage::Tile *> &TiledImage::updateRegion(unsigned int level, ImVec2 pos, ImVec2 size,
+                                                                    ImGuiImageSampleType sampleType)
+    {
+        mVisible.clear();
+        if (mImage.width <= 0 || mImage.height <= 0 || size.x <= 0 || size.y <= 0)
+            return mVisible;
+
+        level                = MIN(level, mMaxLevel);
+        unsigned int span    = mTileSize << level;
+        unsigned int columns = (mImage.width + span - 1) / span;
+        unsigned int rows    = (mImage.height + span - 1) / span;
+
+        unsigned int firstColumn = (unsigned int)MAX(pos.x, 0.f) / span;
+        unsigned int firstRow    = (unsigned int)MAX(pos.y, 0.f) / span;
+        unsigned int lastColumn  = MIN((unsigned int)MAX(pos.x + size.x - 1, 0.f) / span, columns - 1);
+        unsigned int lastRow     = MIN((unsigned int)MAX(pos.y + size.y - 1, 0.f) / span, rows - 1);
+
+        for (unsigned int row = firstRow; row <= lastRow; row++)
+        {
+            for (unsigned int column = firstColumn; column <= lastColumn; column++)
+            {
+                unsigned int x    = column * span;
+                unsigned int y    = row * span;
+                Tile        *tile = nullptr;
+                for (auto &resident : mTiles)
+                {
+                    if (resident->level == level && resident->x == x && resident->y == y)
+                    {
+                        tile = resident.get();
+                        break;
+                    }
+                }
+                if (!tile)
+                {
+                    auto newTile    = std::make_unique<Tile>();
+                    newTile->level  = level;
+                    newTile->x      = x;
+                    newTile->y      = y;
+                    newTile->width  = MIN(span, mImage.width - x);
+                    newTile->height = MIN(span, mImage.height - y);
+                    if (!uploadTile(*newTile))
+                        continue;
+                    tile = newTile.get();
+                    mTiles.push_back(std::move(newTile));
+                }
+                tile->lastUsed                = GetFrameCount();
+                tile->renderSource.sampleType = sampleType;
+                mVisible.push_back(tile);
+            }
+        }
+        evictTiles();
+        return mVisible;
+    }
+
+    bool TiledImage::uploadTile(Tile &tile)
+    {
+        if (tile.level == 0)
+        {
+            // full resolution tiles are uploaded straight from the source rows
+            ImageData roi;
+            if (!getImageDataROI(mImage, tile.x, tile.y, tile.width, tile.height, roi)
+                || !updateImageTexture(roi, tile.texture))
+                return false;
+            tile.renderSource = RenderSource(tile.texture, tile.renderSource.sampleType);
+            return true;
+        }
+
+        unsigned int scale = 1u << tile.level;
+        // at most 4x4 taps per pixel like the area sample of the shader
+        unsigned int taps = MIN(scale, 4u);
+        unsigned int step = scale / taps;
+
+        ImageData level  = {};
+        level.format     = mImage.format;
+        level.colorRange = mImage.colorRange;
+        level.colorSpace = mImage.colorSpace;
+        level.width      = (tile.width + scale - 1) / scale;
+        level.height     = (tile.height + scale - 1) / scale;
+
+        unsigned int planeCount                        = getPlaneCount(mImage.format);
+        unsigned int componentBytes                    = getComponentBytes(mImage.format);
+        size_t       planeSize[IMGUI_IMAGE_MAX_PLANES] = {0};
+        size_t       totalSize                         = 0;
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int planeWidth    = 0;
+            unsigned int planeHeight   = 0;
+            getPlaneInfo(mImage.format, level.width, level.height, i, &bytesPerPixel, &planeWidth, &planeHeight);
+            level.stride[i] = planeWidth * bytesPerPixel;
+            planeSize[i]    = (size_t)level.stride[i] * planeHeight;
+            totalSize += planeSize[i];
         }
+        mScratch.resize(totalSize);
+
+        uint8_t *planeData = mScratch.data();
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            level.plane[i] = planeData;
+            planeData += planeSize[i];
+
+            // plane size of a 4x2 image gives the subsampling, see getImageDataROI()
+            unsigned int bytesPerPixel = 0;
+            unsigned int subX          = 0;
+            unsigned int subY          = 0;
+            getPlaneInfo(mImage.format, 4, 2, i, &bytesPerPixel, &subX, &subY);
+            subX = 4 / subX;
+            subY = 2 / subY;
 
-        texturePos  = topLeft;
-        textureSize = bottomRight - topLeft;
+            unsigned int srcWidth  = 0;
+            unsigned int srcHeight = 0;
+            unsigned int dstWidth  = 0;
+            unsigned int dstHeight = 0;
+            getPlaneInfo(mImage.format, mImage.width, mImage.height, i, &bytesPerPixel, &srcWidth, &srcHeight);
+            getPlaneInfo(mImage.format, level.width, level.height, i, &bytesPerPixel, &dstWidth, &dstHeight);
+            if (srcWidth == 0 || srcHeight == 0)
+                continue;
 
-        renderPos  = renderTopLeft;
-        renderSize = renderBottomRight - renderTopLeft;
+            // source column of every tap, clamped to the image
+            std::vector<unsigned int> columns((size_t)dstWidth * taps);
+            for (unsigned int x = 0; x < dstWidth; x++)
+            {
+                for (unsigned int t = 0; t < taps; t++)
+                    columns[x * taps + t] = MIN(tile.x / subX + x * scale + t * step + step / 2, srcWidth - 1);
+            }
+
+            for (unsigned int y = 0; y < dstHeight; y++)
+            {
+                const uint8_t *srcRows[4];
+                for (unsigned int t = 0; t < taps; t++)
+                {
+                    unsigned int srcY = MIN(tile.y / subY + y * scale + t * step + step / 2, srcHeight - 1);
+                    srcRows[t]        = mImage.plane[i] + (size_t)srcY * mImage.stride[i];
+                }
+                uint8_t     *dst        = level.plane[i] + (size_t)y * level.stride[i];
+                unsigned int components = bytesPerPixel / componentBytes;
+                if (componentBytes == 4)
+                    averageTapsRow<float, float>(srcRows, columns.data(), taps, components, dstWidth, dst);
+                else if (componentBytes == 2)
+                    averageTapsRow<uint16_t, unsigned int>(srcRows, columns.data(), taps, components, dstWidth, dst);
+                else
+                    averageTapsRow<uint8_t, unsigned int>(srcRows, columns.data(), taps, components, dstWidth, dst);
+            }
+        }
 
+        if (!updateImageTexture(level, tile.texture))
+            return false;
+        tile.renderSource = RenderSource(tile.texture, tile.renderSource.sampleType);
         return true;
     }
 
-} // namespace ImGui
\ No newline at end of file
+    void TiledImage::evictTiles()
+    {
+        int frame = GetFrameCount();
+        while (mTiles.size() > mResidentLimit)
+        {
+            auto oldest = mTiles.end();
+            for (auto it = mTiles.begin(); it != mTiles.end(); ++it)
+            {
+                if ((*it)->lastUsed != frame && (oldest == mTiles.end() || (*it)->lastUsed < (*oldest)->lastUsed))
+                    oldest = it;
+            }
+            // everything left is drawn this frame
+            if (oldest == mTiles.end())
+                break;
+            mTiles.erase(oldest);
+        }
+    }
+
+} // namespace ImGui
@@ -2,9 +2,14 @@
 #define IMGUI_IMAGE_RENDER_H_
 
 #include <stdint.h>
+#include <memory>
+#include <vector>
 #include "imgui.h"
+#include "ImGuiBaseTypes.h"
 
-#define IMGUI_IMAGE_MAX_PLANES 4
+#define IMGUI_IMAGE_MAX_PLANES     4
+#define IMGUI_IMAGE_STREAM_BUFFERS 3
+#define IMGUI_CAPTURE_BUFFERS      3
 
 #define TextureFormat_RGBA      0
 #define TextureFormat_BGRA      1
@@ -14,6 +19,11 @@
 #define TextureFormat_NV21      5
 #define TextureFormat_Gray      6
 
+// special callback value, the next draw command is the image quad of the RenderSource in UserCallbackData.
+// every renderer drawing these lists must skip it like ImDrawCallback_ResetRenderState, one that calls it as a
+// function pointer crashes. only the OpenGL3 and DX11 backends here handle it
+#define ImDrawCallback_ImageCommand (ImDrawCallback)(-16)
+
 namespace ImGui
 {
 
@@ -39,6 +49,14 @@ namespace ImGui
 
         ImGuiImageFormat_Gray,
 
+        // high bit depth, samples are little endian and uploaded as they are
+        ImGuiImageFormat_P010,        // NV12 layout, 16bit samples with the 10bit value in the high bits
+        ImGuiImageFormat_P016,        // NV12 layout, 16bit samples
+        ImGuiImageFormat_YUV420P10LE, // planar YUV 4:2:0, 16bit samples with the 10bit value in the low bits
+        ImGuiImageFormat_Gray16,
+        ImGuiImageFormat_RGBA16, // packed RGBA, 16bit per component
+        ImGuiImageFormat_R32F,   // one float per pixel shown as gray, values out of 0~1 are clamped
+
 #if IMGUI_RENDER_API == IMGUI_RENDER_API_DX11
         ImGuiImageFormat_Dx11,
 #endif
@@ -57,7 +75,22 @@ namespace ImGui
     };
 #define INVALID_COLOR_RANGE(t) ((t) < 0 || (t) >= ImGuiImageColorRange_Max)
 
+    // YUV to RGB matrix
+    enum ImGuiImageColorSpace
+    {
+        ImGuiImageColorSpace_BT601,
+        ImGuiImageColorSpace_BT709,
+        ImGuiImageColorSpace_BT2020,
+
+        ImGuiImageColorSpace_Max,
+    };
+#define INVALID_COLOR_SPACE(t) ((t) < 0 || (t) >= ImGuiImageColorSpace_Max)
+
     int          getTextureFormat(ImGuiImageFormat imageFormat);
+    // factor bringing the sampled value of the texture to 0~1, for samples not using all bits of their component
+    float        getTextureValueScale(ImGuiImageFormat imageFormat);
+    // bytes of one component of a pixel, 4 means float
+    unsigned int getComponentBytes(ImGuiImageFormat format);
     unsigned int getPlaneCount(ImGuiImageFormat format);
     int          getPlaneInfo(ImGuiImageFormat format, unsigned int imageWidth, unsigned int imageHeight, unsigned int plane,
                               unsigned int *bytesPerPixel, unsigned int *width, unsigned int *height);
@@ -83,12 +116,72 @@ namespace ImGui
         unsigned int         stride[IMGUI_IMAGE_MAX_PLANES];
         ImGuiImageFormat     format;
         ImGuiImageColorRange colorRange;
+        ImGuiImageColorSpace colorSpace = ImGuiImageColorSpace_BT601;
+
+        // optional, keeps the plane memory alive while the image is queued (see TextureStream)
+        std::shared_ptr<void> holder;
+    };
+
+    // sub-rectangle of image sharing its memory, x/y must be aligned to the chroma subsampling of the format.
+    // uploading roi needs no copy as the stride of the parent image is kept
+    bool getImageDataROI(const ImageData &image, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                         ImageData &roi);
+
+    // convert image to packed RGBA8888 on CPU, for screenshots, thumbnails and exports.
+    // YUV uses the same matrix as the shaders so the result matches what is displayed.
+    // dstStride 0 means width * 4. large frames are split into row bands across threads
+    bool convertImageToRGBA(const ImageData &image, uint8_t *dst, unsigned int dstStride = 0);
+
+    // convert packed RGBA8888 to I420 for encoders and raw dumps, each chroma sample is the average of its 2x2 pixels.
+    // dst must be ImGuiImageFormat_YUV420P of even width and height with the planes allocated, its colorRange and
+    // colorSpace select the matrix
+    bool convertRGBAToI420(const uint8_t *src, unsigned int srcStride, ImageData &dst);
+
+    // kernels of the CPU conversions, the best one the cpu supports is used by default
+    enum ImGuiImageConvertKernel
+    {
+        ImGuiImageConvertKernel_C,
+        ImGuiImageConvertKernel_SSE2,
+        ImGuiImageConvertKernel_AVX2,
+
+        ImGuiImageConvertKernel_Max,
     };
+    // for benchmarks and comparisons, not while a conversion is running. falls back to the best supported one below
+    // kernel and returns false if the cpu doesn't support kernel
+    bool                    setImageConvertKernel(ImGuiImageConvertKernel kernel);
+    ImGuiImageConvertKernel getImageConvertKernel();
 
     // Render Backend Relative
     struct TextureSource;
     bool updateImageTexture(ImageData &image, TextureSource &texture);
+    // Map the next pixel buffer of a streaming texture so a producer can write the frame straight into driver memory.
+    // image.format/width/height/colorRange describe the frame, plane/stride are filled on success.
+    // unmapImageTexture() queues the texture update from the buffer. Both must be called on the render thread.
+    bool mapImageTexture(TextureSource &texture, ImageData &image);
+    bool unmapImageTexture(TextureSource &texture);
     void freeTexture(TextureSource &pTexture);
+
+    // textures given up by TextureSource are kept and handed out again to a texture of the same plane size and format.
+    // the least recently released ones are destroyed beyond the capacity, 0 disables the pool
+    struct TexturePoolStats
+    {
+        uint64_t     hits;
+        uint64_t     misses;
+        unsigned int pooledCount;
+        unsigned int capacity;
+    };
+    void             setTexturePoolCapacity(unsigned int textureCount);
+    TexturePoolStats getTexturePoolStats();
+    void             clearTexturePool();
+
+    // Asynchronous readback of the main viewport for screenshots and recording. The frame being built is copied to a
+    // ring of IMGUI_CAPTURE_BUFFERS pixel pack buffers once rendered and fetched when its fence signals, neither that
+    // frame nor the next waits for the GPU. callback runs on a worker thread with a packed RGBA image, top row first,
+    // the memory is owned by image.holder, or with an empty image (width 0) if the readback failed or the renderer shut
+    // down first. regionPos/regionSize are in main viewport coordinates, an empty region captures the whole framebuffer.
+    // Any thread, requests beyond the free buffers are served in the next frames
+    typedef std::function<void(ImageData &image)> FrameCaptureCallback;
+    bool captureFrame(const FrameCaptureCallback &callback, ImVec2 regionPos = ImVec2(0, 0), ImVec2 regionSize = ImVec2(0, 0));
     // End for Render Backend Relative\
 
     // mat must be RGBA8888
@@ -111,9 +204,22 @@ namespace ImGui
         uintptr_t            textureID[IMGUI_IMAGE_MAX_PLANES] = {0};
         ImGuiImageFormat     imageFormat                       = ImGuiImageFormat_RGBA;
         ImGuiImageColorRange colorRange                        = ImGuiImageColorRange_0_255;
+        ImGuiImageColorSpace colorSpace                        = ImGuiImageColorSpace_BT601;
         int                  width                             = 0;
         int                  height                            = 0;
+
+        // build the mip chain on every upload, minified draws then sample trilinear instead of the area shader path
+        bool mipmaps = false;
+
+        // upload through a ring of pixel buffers, updateImageTexture() returns without waiting for the GPU
+        bool         streaming                                                        = false;
+        uintptr_t    streamBuffer[IMGUI_IMAGE_MAX_PLANES][IMGUI_IMAGE_STREAM_BUFFERS]     = {{0}};
+        size_t       streamBufferSize[IMGUI_IMAGE_MAX_PLANES][IMGUI_IMAGE_STREAM_BUFFERS] = {{0}};
+        unsigned int streamIndex                                                      = 0;
+        bool         streamMapped                                                     = false;
     };
+    // exchange the GPU resources of two textures, for double buffering an upload that may be thrown away
+    void swapTextureSource(TextureSource &a, TextureSource &b);
 
     struct RenderSource
     {
@@ -123,13 +229,109 @@ namespace ImGui
         uintptr_t            textureID[IMGUI_IMAGE_MAX_PLANES] = {0};
         ImGuiImageFormat     imageFormat                       = ImGuiImageFormat_RGBA;
         ImGuiImageColorRange colorRange                        = ImGuiImageColorRange_0_255;
+        ImGuiImageColorSpace colorSpace                        = ImGuiImageColorSpace_BT601;
         int                  width                             = 0;
         int                  height                            = 0;
+        bool                 mipmaps                           = false;
 
         ImGuiImageSampleType sampleType = ImGuiImageSampleType_Linear;
     };
 
-    bool checkTextureRect(ImDrawVert vertices[6], ImVec2 &texturePos, ImVec2 &textureSize, ImVec2 &renderPos, ImVec2 &renderSize);
+    // Hand frames from any thread to the render thread.
+    // The newest submitted frame is latched and uploaded once at the start of the next GUI frame,
+    // frames replaced before that are dropped without being copied.
+    class TextureStream
+    {
+    public:
+        TextureStream();
+        virtual ~TextureStream();
+        TextureStream(const TextureStream &)            = delete;
+        TextureStream &operator=(const TextureStream &) = delete;
+
+        // any thread. plane memory must stay valid until uploaded, set image.holder to hand its ownership over
+        void submit(ImageData &&image);
+        // render thread, return true if a new frame was uploaded
+        bool update();
+
+        TextureSource &texture() { return mTexture; }
+        uint64_t       submittedFrames();
+        uint64_t       droppedFrames();
+
+    private:
+        TextureSource mTexture;
+        StdMutex      mLock;
+        ImageData     mPending        = {};
+        bool          mHasPending     = false;
+        uint64_t      mSubmittedCount = 0;
+        uint64_t      mDroppedCount   = 0;
+    };
+
+    // upload latched frames of all TextureStream, called by the main loop before newFramePreAction()
+    void updateTextureStreams();
+
+    // Image larger than the texture size limit, split into tiles of which only the ones in view are uploaded.
+    // Zoomed out views use coarser levels, whose tiles are box-filtered on CPU, so memory follows the viewport.
+    class TiledImage
+    {
+    public:
+        struct Tile
+        {
+            unsigned int  level;
+            unsigned int  x; // region of the source image covered by the tile
+            unsigned int  y;
+            unsigned int  width;
+            unsigned int  height;
+            TextureSource texture;
+            RenderSource  renderSource;
+            int           lastUsed; // frame count, tiles used this frame may be in the draw data
+        };
+
+        // tileSize is rounded up to a multiple of 4 to stay on the chroma subsampling
+        explicit TiledImage(unsigned int tileSize = 1024, unsigned int residentTiles = 64);
+        TiledImage(const TiledImage &)            = delete;
+        TiledImage &operator=(const TiledImage &) = delete;
+
+        // plane memory is not copied and must stay valid while set, set image.holder to hand its ownership over
+        bool setImage(const ImageData &image);
+        void clear();
+
+        unsigned int width() const { return mImage.width; }
+        unsigned int height() const { return mImage.height; }
+        unsigned int tileSize() const { return mTileSize; }
+        unsigned int residentTiles() const { return (unsigned int)mTiles.size(); }
+        void         setResidentLimit(unsigned int tileCount) { mResidentLimit = tileCount; }
+
+        // level to use when one source pixel is drawn pixelScale screen pixels large
+        unsigned int getLevel(float pixelScale) const;
+        // make the tiles of level intersecting the region of the source image resident and return them.
+        // least recently used tiles beyond the limit are freed, never one used in the current frame since it may
+        // already be in the draw data of another window or level. render thread only
+        const std::vector<Tile *> &updateRegion(unsigned int level, ImVec2 pos, ImVec2 size, ImGuiImageSampleType sampleType);
+
+    private:
+        bool uploadTile(Tile &tile);
+        void evictTiles();
+
+        ImageData                          mImage = {};
+        unsigned int                       mTileSize;
+        unsigned int                       mResidentLimit;
+        unsigned int                       mMaxLevel = 0;
+        std::vector<std::unique_ptr<Tile>> mTiles;
+        std::vector<Tile *>                mVisible;
+        std::vector<uint8_t>               mScratch;
+    };
+
+    // Images are submitted as a ImDrawCallback_ImageCommand callback carrying the RenderSource, followed by the image quad.
+    // The backends draw that quad through the image shader path, any other command is drawn as plain ImGui geometry.
+    void addImageCommand(ImDrawList *drawList, RenderSource &source, const ImVec2 &pMin, const ImVec2 &pMax,
+                         const ImVec2 &uvMin = ImVec2(0, 0), const ImVec2 &uvMax = ImVec2(1, 1));
+    // A RenderSource passed straight to ImGui::Image()/ImageButton() comes without the callback, the backends draw such
+    // a lone quad through the image shader too when the plain path can't show it (not 8-bit RGBA, or not linear sampled)
+    bool needsImageShader(const RenderSource &source);
+    // used by the backends on the command following ImDrawCallback_ImageCommand, false if it is not an axis aligned
+    // AddImage() quad
+    bool getImageCommandRect(const ImDrawList *drawList, const ImDrawCmd *pcmd, const RenderSource *source, ImVec2 &texturePos,
+                             ImVec2 &textureSize, ImVec2 &renderPos, ImVec2 &renderSize);
     const char *getShaderCode();
 
 } // namespace ImGui
@@ -0,0 +1,583 @@
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "imgui_image_stats.h"
+#include "imgui_common_tools.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMGUI_IMAGE_STATS_X86
+    #include <emmintrin.h>
+#endif
+
+namespace ImGui
+{
+    struct StatsChannelLayout
+    {
+        char         name[4];
+        unsigned int plane;
+        unsigned int offset; // components before the first sample in a pixel of the plane
+        unsigned int step;   // components per pixel of the plane
+        unsigned int width;  // in samples of this channel
+        unsigned int height;
+        unsigned int subX;
+        unsigned int subY;
+        unsigned int componentBytes;
+        unsigned int shift; // P010 keeps the value in the high bits
+        unsigned int maxValue;
+        unsigned int clipLow;
+        unsigned int clipHigh;
+    };
+
+    struct ImageIntegralChannel
+    {
+        char                  name[4];
+        unsigned int          width;
+        unsigned int          height;
+        unsigned int          subX;
+        unsigned int          subY;
+        std::vector<uint64_t> sum;   // (width + 1) x (height + 1), the first row and column are 0
+        std::vector<uint64_t> sumSq;
+    };
+
+    struct ImageIntegrals
+    {
+        int                  channelCount;
+        ImageIntegralChannel channels[IMGUI_STATS_MAX_CHANNELS];
+    };
+
+    static int getStatsChannels(const ImageData &image, StatsChannelLayout *channels)
+    {
+        int  count = 0;
+        auto add   = [&](const char *name, unsigned int plane, unsigned int offset, unsigned int step)
+        {
+            StatsChannelLayout &channel = channels[count++];
+            channel                     = {};
+            strncpy(channel.name, name, sizeof(channel.name) - 1);
+            channel.plane  = plane;
+            channel.offset = offset;
+            channel.step   = step;
+
+            // plane size of a 4x2 image gives the subsampling, see getImageDataROI()
+            unsigned int bytesPerPixel = 0;
+            unsigned int planeWidth    = 0;
+            unsigned int planeHeight   = 0;
+            getPlaneInfo(image.format, 4, 2, plane, &bytesPerPixel, &planeWidth, &planeHeight);
+            channel.subX = 4 / planeWidth;
+            channel.subY = 2 / planeHeight;
+            getPlaneInfo(image.format, image.width, image.height, plane, &bytesPerPixel, &channel.width, &channel.height);
+        };
+
+        unsigned int bits  = 8;
+        unsigned int shift = 0;
+        switch (image.format)
+        {
+            default:
+                return 0;
+            case ImGuiImageFormat_RGBA16:
+                bits = 16;
+                [[fallthrough]];
+            case ImGuiImageFormat_RGBA:
+                add("R", 0, 0, 4);
+                add("G", 0, 1, 4);
+                add("B", 0, 2, 4);
+                add("A", 0, 3, 4);
+                break;
+            case ImGuiImageFormat_BGRA:
+                add("R", 0, 2, 4);
+                add("G", 0, 1, 4);
+                add("B", 0, 0, 4);
+                add("A", 0, 3, 4);
+                break;
+            case ImGuiImageFormat_Gray16:
+                bits = 16;
+                [[fallthrough]];
+            case ImGuiImageFormat_Gray:
+                add("Y", 0, 0, 1);
+                break;
+            case ImGuiImageFormat_YUV420P10LE:
+                bits = 10;
+                [[fallthrough]];
+            case ImGuiImageFormat_YUV444P:
+            case ImGuiImageFormat_YUV422P:
+            case ImGuiImageFormat_YUV411P:
+            case ImGuiImageFormat_YUV420P:
+                add("Y", 0, 0, 1);
+                add("U", 1, 0, 1);
+                add("V", 2, 0, 1);
+                break;
+            case ImGuiImageFormat_YV12:
+                add("Y", 0, 0, 1);
+                add("U", 2, 0, 1);
+                add("V", 1, 0, 1);
+                break;
+            case ImGuiImageFormat_P010:
+                bits  = 10;
+                shift = 6;
+                add("Y", 0, 0, 1);
+                add("U", 1, 0, 2);
+                add("V", 1, 1, 2);
+                break;
+            case ImGuiImageFormat_P016:
+                bits = 16;
+                [[fallthrough]];
+            case ImGuiImageFormat_NV12:
+                add("Y", 0, 0, 1);
+                add("U", 1, 0, 2);
+                add("V", 1, 1, 2);
+                break;
+            case ImGuiImageFormat_NV21:
+                add("Y", 0, 0, 1);
+                add("U", 1, 1, 2);
+                add("V", 1, 0, 2);
+                break;
+        }
+
+        bool limited = image.colorRange == ImGuiImageColorRange_16_235;
+        for (int i = 0; i < count; i++)
+        {
+            StatsChannelLayout &channel = channels[i];
+
+            channel.componentBytes = getComponentBytes(image.format);
+            channel.shift          = shift;
+            channel.maxValue       = (1u << bits) - 1;
+            channel.clipLow        = 0;
+            channel.clipHigh       = channel.maxValue;
+            if (limited && channel.name[0] != 'A')
+            {
+                bool chroma      = channel.name[0] == 'U' || channel.name[0] == 'V';
+                channel.clipLow  = 16u << (bits - 8);
+                channel.clipHigh = (chroma ? 240u : 235u) << (bits - 8);
+            }
+        }
+        return count;
+    }
+
+    static inline unsigned int readSample(const StatsChannelLayout &channel, const uint8_t *row, unsigned int i)
+    {
+        unsigned int index = i * channel.step + channel.offset;
+        if (channel.componentBytes == 1)
+            return row[index];
+        return MIN((unsigned int)(((const uint16_t *)row)[index] >> channel.shift), channel.maxValue);
+    }
+
+    // below about 1MPix handing bands to the workers costs more than it saves, as in convertImageToRGBA()
+    static unsigned int getBandCount(unsigned int rows, size_t samples)
+    {
+        if (samples < 1024 * 1024)
+            return 1;
+        unsigned int bandCount = MAX(std::thread::hardware_concurrency(), 1u);
+        bandCount              = MIN(bandCount, 8u);
+        bandCount              = MIN(bandCount, rows / 16);
+        return MAX(bandCount, 1u);
+    }
+
+    static void runBands(unsigned int bandCount, unsigned int rows,
+                         const std::function<void(unsigned int band, unsigned int rowBegin, unsigned int rowEnd)> &func)
+    {
+        unsigned int rowsPerBand = (rows + bandCount - 1) / bandCount;
+        runParallel(bandCount,
+                    [&](unsigned int band)
+                    {
+                        unsigned int rowBegin = band * rowsPerBand;
+                        unsigned int rowEnd   = MIN(rowBegin + rowsPerBand, rows);
+                        if (rowBegin < rowEnd)
+                            func(band, rowBegin, rowEnd);
+                    });
+    }
+
+    static void countRows(const ImageData &image, const StatsChannelLayout &channel, unsigned int x0, unsigned int x1,
+                          unsigned int rowBegin, unsigned int rowEnd, uint32_t *histogram)
+    {
+        unsigned int count  = x1 - x0;
+        unsigned int stride = image.stride[channel.plane];
+        if (channel.componentBytes == 1)
+        {
+            // 4 partial histograms so runs of the same value don't wait on the previous increment
+            uint32_t     partial[4][256] = {};
+            unsigned int step            = channel.step;
+            for (unsigned int row = rowBegin; row < rowEnd; row++)
+            {
+                const uint8_t *src = image.plane[channel.plane] + (size_t)row * stride + x0 * step + channel.offset;
+                unsigned int   i   = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    partial[0][src[i * step]]++;
+                    partial[1][src[(i + 1) * step]]++;
+                    partial[2][src[(i + 2) * step]]++;
+                    partial[3][src[(i + 3) * step]]++;
+                }
+                for (; i < count; i++)
+                    partial[0][src[i * step]]++;
+            }
+            for (int value = 0; value < 256; value++)
+                histogram[value] += partial[0][value] + partial[1][value] + partial[2][value] + partial[3][value];
+            return;
+        }
+
+        for (unsigned int row = rowBegin; row < rowEnd; row++)
+        {
+            const uint8_t *src = image.plane[channel.plane] + (size_t)row * stride;
+            for (unsigned int i = x0; i < x1; i++)
+                histogram[readSample(channel, src, i)]++;
+        }
+    }
+
+    static void computeRegionStats(const ImageData &image, const unsigned int region[4], ImageRegionStats &stats)
+    {
+        StatsChannelLayout channels[IMGUI_STATS_MAX_CHANNELS];
+
+        stats.channelCount = getStatsChannels(image, channels);
+        stats.x            = MIN(region[0], image.width);
+        stats.y            = MIN(region[1], image.height);
+        stats.width        = region[2] == 0 ? image.width : MIN(region[2], image.width - stats.x);
+        stats.height       = region[3] == 0 ? image.height : MIN(region[3], image.height - stats.y);
+
+        for (int c = 0; c < stats.channelCount; c++)
+        {
+            const StatsChannelLayout &channel = channels[c];
+            ImageChannelStats        &out     = stats.channels[c];
+
+            memcpy(out.name, channel.name, sizeof(out.name));
+            out.maxValue = channel.maxValue;
+
+            // partially covered chroma samples are counted
+            unsigned int x0 = stats.x / channel.subX;
+            unsigned int y0 = stats.y / channel.subY;
+            unsigned int x1 = MIN((stats.x + stats.width + channel.subX - 1) / channel.subX, channel.width);
+            unsigned int y1 = MIN((stats.y + stats.height + channel.subY - 1) / channel.subY, channel.height);
+            if (x1 <= x0 || y1 <= y0)
+                continue;
+
+            size_t       levels    = (size_t)channel.maxValue + 1;
+            unsigned int bandCount = getBandCount(y1 - y0, (size_t)(x1 - x0) * (y1 - y0));
+
+            std::vector<uint32_t> bandHistograms(levels * bandCount);
+            runBands(bandCount, y1 - y0,
+                     [&](unsigned int band, unsigned int rowBegin, unsigned int rowEnd)
+                     { countRows(image, channel, x0, x1, y0 + rowBegin, y0 + rowEnd, &bandHistograms[band * levels]); });
+
+            std::vector<uint64_t> histogram(levels);
+            for (unsigned int band = 0; band < bandCount; band++)
+            {
+                for (size_t value = 0; value < levels; value++)
+                    histogram[value] += bandHistograms[band * levels + value];
+            }
+
+            uint64_t sum = 0;
+            out.min      = channel.maxValue;
+            for (size_t value = 0; value < levels; value++)
+            {
+                uint64_t count = histogram[value];
+                if (count == 0)
+                    continue;
+                out.count += count;
+                out.min = MIN(out.min, (unsigned int)value);
+                out.max = (unsigned int)value;
+                sum += count * value;
+                if (value <= channel.clipLow)
+                    out.clippedLow += count;
+                if (value >= channel.clipHigh)
+                    out.clippedHigh += count;
+                out.histogram[value * IMGUI_STATS_HISTOGRAM_BINS / levels] += (uint32_t)MIN(count, (uint64_t)UINT32_MAX);
+            }
+            out.mean = (double)sum / out.count;
+
+            double variance = 0;
+            for (unsigned int value = out.min; value <= out.max; value++)
+                variance += histogram[value] * (value - out.mean) * (value - out.mean);
+            out.stddev = sqrt(variance / out.count);
+        }
+    }
+
+    // dst += src, the vertical pass of the integral images
+    static void addRow64(uint64_t *dst, const uint64_t *src, size_t count)
+    {
+        size_t i = 0;
+#ifdef IMGUI_IMAGE_STATS_X86
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i dst0 = _mm_loadu_si128((const __m128i *)(dst + i));
+            __m128i dst1 = _mm_loadu_si128((const __m128i *)(dst + i + 2));
+            __m128i src0 = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i src1 = _mm_loadu_si128((const __m128i *)(src + i + 2));
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi64(dst0, src0));
+            _mm_storeu_si128((__m128i *)(dst + i + 2), _mm_add_epi64(dst1, src1));
+        }
+#endif
+        for (; i < count; i++)
+            dst[i] += src[i];
+    }
+
+    static bool buildIntegrals(const ImageData &image, ImageIntegrals &integrals)
+    {
+        StatsChannelLayout channels[IMGUI_STATS_MAX_CHANNELS];
+
+        integrals.channelCount = getStatsChannels(image, channels);
+        size_t samples         = 0;
+        for (int c = 0; c < integrals.channelCount; c++)
+            samples += (size_t)channels[c].width * channels[c].height;
+        if (samples > IMGUI_STATS_INTEGRAL_MAX_SAMPLES)
+            return false;
+
+        for (int c = 0; c < integrals.channelCount; c++)
+        {
+            const StatsChannelLayout &channel  = channels[c];
+            ImageIntegralChannel     &integral = integrals.channels[c];
+
+            memcpy(integral.name, channel.name, sizeof(integral.name));
+            integral.width  = channel.width;
+            integral.height = channel.height;
+            integral.subX   = channel.subX;
+            integral.subY   = channel.subY;
+
+            size_t stride = (size_t)channel.width + 1;
+            integral.sum.assign(stride * (channel.height + 1), 0);
+            integral.sumSq.assign(stride * (channel.height + 1), 0);
+
+            unsigned int bandCount = getBandCount(channel.height, (size_t)channel.width * channel.height);
+
+            // prefix sums of every row, rows are independent
+            runBands(bandCount, channel.height,
+                     [&](unsigned int, unsigned int rowBegin, unsigned int rowEnd)
+                     {
+                         for (unsigned int row = rowBegin; row < rowEnd; row++)
+                         {
+                             const uint8_t *src   = image.plane[channel.plane] + (size_t)row * image.stride[channel.plane];
+                             uint64_t      *sum   = &integral.sum[(row + 1) * stride + 1];
+                             uint64_t      *sumSq = &integral.sumSq[(row + 1) * stride + 1];
+                             uint64_t       total = 0, totalSq = 0;
+                             for (unsigned int i = 0; i < channel.width; i++)
+                             {
+                                 uint64_t value = readSample(channel, src, i);
+                                 total += value;
+                                 totalSq += value * value;
+                                 sum[i]   = total;
+                                 sumSq[i] = totalSq;
+                             }
+                         }
+                     });
+
+            // then down the columns, split into column bands that each walk all rows
+            runBands(bandCount, (unsigned int)stride,
+                     [&](unsigned int, unsigned int colBegin, unsigned int colEnd)
+                     {
+                         for (unsigned int row = 2; row <= channel.height; row++)
+                         {
+                             addRow64(&integral.sum[row * stride + colBegin], &integral.sum[(row - 1) * stride + colBegin],
+                                      colEnd - colBegin);
+                             addRow64(&integral.sumSq[row * stride + colBegin], &integral.sumSq[(row - 1) * stride + colBegin],
+                                      colEnd - colBegin);
+                         }
+                     });
+        }
+        return true;
+    }
+
+    ImageStatistics::~ImageStatistics()
+    {
+        {
+            StdMutexGuard lock(mLock);
+            mQuit = true;
+        }
+        mCond.notify_one();
+        if (mWorker.joinable())
+            mWorker.join();
+    }
+
+    bool ImageStatistics::setImage(const ImageData &image)
+    {
+        StatsChannelLayout channels[IMGUI_STATS_MAX_CHANNELS];
+        if (image.width == 0 || image.height == 0 || getStatsChannels(image, channels) == 0)
+        {
+            dbg("image format %d not supported by statistics\n", image.format);
+            return false;
+        }
+        unsigned int planeCount = getPlaneCount(image.format);
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            if (!image.plane[i])
+                return false;
+        }
+
+        ImageData copy = image;
+        if (!image.holder)
+        {
+            unsigned int rowBytes[IMGUI_IMAGE_MAX_PLANES] = {};
+            unsigned int rows[IMGUI_IMAGE_MAX_PLANES]     = {};
+            size_t       total                            = 0;
+            for (unsigned int i = 0; i < planeCount; i++)
+            {
+                unsigned int bytesPerPixel = 0;
+                getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &rowBytes[i], &rows[i]);
+                rowBytes[i] *= bytesPerPixel;
+                total += (size_t)rowBytes[i] * rows[i];
+            }
+
+            std::shared_ptr<uint8_t> data(new uint8_t[total], std::default_delete<uint8_t[]>());
+            uint8_t                 *dst = data.get();
+            for (unsigned int i = 0; i < planeCount; i++)
+            {
+                copy.plane[i]  = dst;
+                copy.stride[i] = rowBytes[i];
+                for (unsigned int row = 0; row < rows[i]; row++)
+                    memcpy(dst + (size_t)row * rowBytes[i], image.plane[i] + (size_t)row * image.stride[i], rowBytes[i]);
+                dst += (size_t)rowBytes[i] * rows[i];
+            }
+            copy.holder = data;
+        }
+
+        {
+            StdMutexGuard lock(mLock);
+            mImage         = copy;
+            mHasImage      = true;
+            mBuildPending  = true;
+            mRegionPending = mRegionValid;
+            mImageSerial++;
+            mIntegrals.reset();
+            if (!mWorker.joinable())
+                mWorker = std::thread(&ImageStatistics::worker, this);
+        }
+        mCond.notify_one();
+        return true;
+    }
+
+    void ImageStatistics::clear()
+    {
+        StdMutexGuard lock(mLock);
+        mImage         = {};
+        mHasImage      = false;
+        mBuildPending  = false;
+        mRegionPending = false;
+        mImageSerial++;
+        mIntegrals.reset();
+        mResult.reset();
+        mResultNew = false;
+    }
+
+    bool ImageStatistics::hasImage()
+    {
+        StdMutexGuard lock(mLock);
+        return mHasImage;
+    }
+
+    void ImageStatistics::requestRegion(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+    {
+        {
+            StdMutexGuard lock(mLock);
+            mRegion[0]     = x;
+            mRegion[1]     = y;
+            mRegion[2]     = width;
+            mRegion[3]     = height;
+            mRegionValid   = true;
+            mRegionPending = mHasImage;
+        }
+        mCond.notify_one();
+    }
+
+    bool ImageStatistics::fetchResult(ImageRegionStats &stats)
+    {
+        StdMutexGuard lock(mLock);
+        if (!mResultNew || !mResult)
+            return false;
+        stats      = *mResult;
+        mResultNew = false;
+        return true;
+    }
+
+    bool ImageStatistics::queryMean(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                                    ImageRegionMean &mean)
+    {
+        std::shared_ptr<ImageIntegrals> integrals;
+        {
+            StdMutexGuard lock(mLock);
+            integrals = mIntegrals;
+        }
+        if (!integrals || width == 0 || height == 0)
+            return false;
+
+        mean.channelCount = integrals->channelCount;
+        for (int c = 0; c < integrals->channelCount; c++)
+        {
+            const ImageIntegralChannel &channel = integrals->channels[c];
+
+            size_t       stride = (size_t)channel.width + 1;
+            unsigned int x0     = MIN(x / channel.subX, channel.width);
+            unsigned int y0     = MIN(y / channel.subY, channel.height);
+            unsigned int x1     = MIN((x + width + channel.subX - 1) / channel.subX, channel.width);
+            unsigned int y1     = MIN((y + height + channel.subY - 1) / channel.subY, channel.height);
+            if (x1 <= x0 || y1 <= y0)
+                return false;
+
+            auto rect = [&](const std::vector<uint64_t> &integral)
+            {
+                return integral[y1 * stride + x1] - integral[y0 * stride + x1] - integral[y1 * stride + x0]
+                     + integral[y0 * stride + x0];
+            };
+            double count    = (double)(x1 - x0) * (y1 - y0);
+            double average  = rect(channel.sum) / count;
+            double variance = rect(channel.sumSq) / count - average * average;
+
+            memcpy(mean.name[c], channel.name, sizeof(mean.name[c]));
+            mean.mean[c]   = average;
+            mean.stddev[c] = sqrt(MAX(variance, 0.0));
+        }
+        return true;
+    }
+
+    void ImageStatistics::worker()
+    {
+        StdMutexUniqueLock lock(mLock);
+        while (true)
+        {
+            mCond.wait(lock, [this]() { return mQuit || mBuildPending || mRegionPending; });
+            if (mQuit)
+                break;
+
+            // the holder keeps the planes alive if the image is replaced meanwhile
+            ImageData image  = mImage;
+            uint32_t  serial = mImageSerial;
+
+            // the region first, it is what the panel is waiting for
+            if (mRegionPending)
+            {
+                unsigned int region[4];
+                memcpy(region, mRegion, sizeof(region));
+                mRegionPending = false;
+                lock.unlock();
+
+                auto start  = std::chrono::steady_clock::now();
+                auto result = std::make_shared<ImageRegionStats>();
+                computeRegionStats(image, region, *result);
+                result->computeMs =
+                    std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                lock.lock();
+                if (serial == mImageSerial)
+                {
+                    mResult    = result;
+                    mResultNew = true;
+                }
+                lock.unlock();
+                requestRedraw();
+                lock.lock();
+            }
+
+            if (mBuildPending && serial == mImageSerial)
+            {
+                mBuildPending = false;
+                lock.unlock();
+
+                auto integrals = std::make_shared<ImageIntegrals>();
+                bool built     = buildIntegrals(image, *integrals);
+
+                lock.lock();
+                if (built && serial == mImageSerial)
+                    mIntegrals = integrals;
+            }
+        }
+    }
+
+} // namespace ImGui
@@ -0,0 +1,101 @@
+#ifndef IMGUI_IMAGE_STATS_H_
+#define IMGUI_IMAGE_STATS_H_
+
+#include <stdint.h>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+
+#include "imgui_image_render.h"
+#include "ImGuiBaseTypes.h"
+
+#define IMGUI_STATS_MAX_CHANNELS         4
+#define IMGUI_STATS_HISTOGRAM_BINS       256
+#define IMGUI_STATS_INTEGRAL_MAX_SAMPLES (1 << 23) // 16 bytes each, larger images get no integral images
+
+namespace ImGui
+{
+    struct ImageChannelStats
+    {
+        char         name[4];
+        unsigned int maxValue; // 255, 1023 or 65535
+        uint64_t     count;
+        unsigned int min;
+        unsigned int max;
+        double       mean;
+        double       stddev;
+        uint64_t     clippedLow;  // at or below black, 16 (scaled to the bit depth) for limited range
+        uint64_t     clippedHigh; // at or above white, 235 for limited range, 240 for limited range chroma
+        uint32_t     histogram[IMGUI_STATS_HISTOGRAM_BINS]; // deeper values are grouped
+    };
+
+    struct ImageRegionStats
+    {
+        unsigned int      x, y, width, height; // clipped to the image
+        int               channelCount;
+        ImageChannelStats channels[IMGUI_STATS_MAX_CHANNELS];
+        float             computeMs;
+    };
+
+    struct ImageRegionMean
+    {
+        int    channelCount;
+        char   name[IMGUI_STATS_MAX_CHANNELS][4]; // same as ImageChannelStats::name
+        double mean[IMGUI_STATS_MAX_CHANNELS];
+        double stddev[IMGUI_STATS_MAX_CHANNELS];
+    };
+
+    struct ImageIntegrals;
+
+    // Statistics of the CPU side of an image, per channel of the format (R/G/B/A, Gray or Y/U/V).
+    // A worker thread does the work so nothing blocks rendering: the histograms of a region are counted in row bands
+    // across threads, and integral images of the sums and squared sums are built once per image so the mean and
+    // standard deviation of any region are O(1) while it is being moved.
+    // R32F and Dx11 images are not supported.
+    class ImageStatistics
+    {
+    public:
+        ImageStatistics() = default;
+        ~ImageStatistics();
+        ImageStatistics(const ImageStatistics &)            = delete;
+        ImageStatistics &operator=(const ImageStatistics &) = delete;
+
+        // the planes are copied unless image.holder keeps them alive
+        bool setImage(const ImageData &image);
+        void clear();
+        bool hasImage();
+
+        // full statistics of a region in image pixels, width/height 0 for the whole image.
+        // a newer request replaces a pending one
+        void requestRegion(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+        // true once for each finished request
+        bool fetchResult(ImageRegionStats &stats);
+
+        // from the integral images, false until they are built or if the image is above IMGUI_STATS_INTEGRAL_MAX_SAMPLES
+        bool queryMean(unsigned int x, unsigned int y, unsigned int width, unsigned int height, ImageRegionMean &mean);
+
+    private:
+        void worker();
+
+        StdMutex                mLock;
+        std::condition_variable mCond;
+        std::thread             mWorker;
+        bool                    mQuit = false;
+
+        ImageData mImage        = {};
+        bool      mHasImage     = false;
+        uint32_t  mImageSerial  = 0;
+        bool      mBuildPending = false;
+
+        bool         mRegionValid   = false; // requested again for a new image
+        bool         mRegionPending = false;
+        unsigned int mRegion[4]     = {};
+
+        std::shared_ptr<ImageIntegrals>   mIntegrals;
+        std::shared_ptr<ImageRegionStats> mResult;
+        bool                              mResultNew = false;
+    };
+
+} // namespace ImGui
+
+#endif
@@ -65,7 +65,9 @@ struct PS_CONSTANT_BUFFER
     int32_t format;
     int32_t useAreaSample;
     int32_t textureColorRange;
-    uint8_t padding[12];
+    float   textureValueScale;
+    int32_t textureColorSpace;
+    uint8_t padding[4];
 };
 static_assert(sizeof(PS_CONSTANT_BUFFER) % 16 == 0, "PS_CONSTANT_BUFFER size must be multiple of 16");
 
@@ -276,12 +278,14 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData *draw_data)
 
     // Render command lists
     // (Because we merged all buffers into a single one, we maintain our own offset into them)
-    int    global_idx_offset = 0;
-    int    global_vtx_offset = 0;
-    ImVec2 clip_off          = draw_data->DisplayPos;
+    int                       global_idx_offset = 0;
+    int                       global_vtx_offset = 0;
+    ImVec2                    clip_off          = draw_data->DisplayPos;
+    ID3D11ShaderResourceView *bound_srv         = nullptr; // srv on slot 0, nullptr when unknown
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
-        const ImDrawList *draw_list = draw_data->CmdLists[n];
+        const ImDrawList *draw_list    = draw_data->CmdLists[n];
+        RenderSource     *image_source = nullptr; // set by ImDrawCallback_ImageCommand for the next command
         for (int cmd_i = 0; cmd_i < draw_list->CmdBuffer.Size; cmd_i++)
         {
             const ImDrawCmd *pcmd = &draw_list->CmdBuffer[cmd_i];
@@ -290,13 +294,22 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData *draw_data)
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer
                 // to reset render state.)
+                if (pcmd->UserCallback == ImDrawCallback_ImageCommand)
+                {
+                    image_source = (RenderSource *)pcmd->UserCallbackData;
+                    continue;
+                }
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
                     ImGui_ImplDX11_SetupRenderState(draw_data, device);
                 else
                     pcmd->UserCallback(draw_list, pcmd);
+                bound_srv = nullptr;
             }
             else
             {
+                RenderSource *image = image_source;
+                image_source        = nullptr;
+
                 // Project scissor/clipping rectangles into framebuffer space
                 ImVec2 clip_min(pcmd->ClipRect.x - clip_off.x, pcmd->ClipRect.y - clip_off.y);
                 ImVec2 clip_max(pcmd->ClipRect.z - clip_off.x, pcmd->ClipRect.w - clip_off.y);
@@ -309,63 +322,65 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData *draw_data)
 
                 // Bind texture, Draw
 
-                RenderSource             *render_source = (RenderSource *)pcmd->GetTexID();
-                ID3D11ShaderResourceView *texture_srv   = nullptr;
-                if (render_source)
-                    texture_srv = (ID3D11ShaderResourceView *)(render_source->textureID[0]);
-                device->PSSetShaderResources(0, 1, &texture_srv);
+                RenderSource       *render_source = (RenderSource *)pcmd->GetTexID();
                 ID3D11SamplerState *currentSampler  = nullptr;
                 bool                needRenderImage = false;
-                if (pcmd->ElemCount == 6) // maybe is a picture
+                ImVec2              texturePos, textureSize;
+                ImVec2              renderPos, renderSize;
+                if (!image && render_source && needsImageShader(*render_source))
+                    image = render_source;
+                if (!getImageCommandRect(draw_list, pcmd, image, texturePos, textureSize, renderPos, renderSize))
                 {
-                    ImDrawVert vertices[6];
-                    auto      *pVertices = draw_list->VtxBuffer.Data + pcmd->VtxOffset;
-                    auto      *indices   = draw_list->IdxBuffer.Data + pcmd->IdxOffset;
-                    for (int i = 0; i < 6; i++)
+                    // plain ImGui geometry, mostly the font atlas, only rebind when the texture changes
+                    ID3D11ShaderResourceView *texture_srv = nullptr;
+                    if (render_source)
+                        texture_srv = (ID3D11ShaderResourceView *)(render_source->textureID[0]);
+                    if (texture_srv != bound_srv)
                     {
-                        int idx     = indices[i];
-                        vertices[i] = pVertices[idx];
+                        device->PSSetShaderResources(0, 1, &texture_srv);
+                        bound_srv = texture_srv;
                     }
-                    ImVec2 texturePos, textureSize;
-                    ImVec2 renderPos, renderSize;
-                    if (checkTextureRect(vertices, texturePos, textureSize, renderPos, renderSize)
-                        && (render_source->sampleType != ImGuiImageSampleType_Linear
-                            || render_source->imageFormat != ImGuiImageFormat_RGBA))
+                }
+                else
+                {
+                    needRenderImage = true;
+
+                    ID3D11ShaderResourceView *srvs[IMGUI_IMAGE_MAX_PLANES];
+                    unsigned int              planes = getPlaneCount(render_source->imageFormat);
+                    for (unsigned int i = 0; i < planes; i++)
                     {
-                        needRenderImage = true;
-
-                        ID3D11ShaderResourceView *srvs[IMGUI_IMAGE_MAX_PLANES];
-                        unsigned int              planes = getPlaneCount(render_source->imageFormat);
-                        for (unsigned int i = 0; i < planes; i++)
-                        {
-                            srvs[i] = (ID3D11ShaderResourceView *)render_source->textureID[i];
-                        }
-
-                        device->PSSetShaderResources(0, planes, srvs);
-
-                        ZeroMemory(&mappedResource, sizeof(mappedResource));
-                        device->Map(bd->pPixelConstantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-                        constantBuffer                    = (PS_CONSTANT_BUFFER *)mappedResource.pData;
-                        constantBuffer->format            = getTextureFormat(render_source->imageFormat);
-                        constantBuffer->textureColorRange = render_source->colorRange;
-                        constantBuffer->useAreaSample     = (render_source->sampleType == ImGuiImageSampleType_Area ? 1 : 0);
-                        // printf("format: %d, colorRange: %d, useAreaSample: %d\n", constantBuffer->format,
-                        //        constantBuffer->textureColorRange, constantBuffer->useAreaSample);
-
-                        constantBuffer->textureSize[0]        = (float)render_source->width;
-                        constantBuffer->textureSize[1]        = (float)render_source->height;
-                        constantBuffer->textureShowingSize[0] = render_source->width * textureSize.x;
-                        constantBuffer->textureShowingSize[1] = render_source->height * textureSize.y;
-                        constantBuffer->renderSize[0]         = renderSize.x;
-                        constantBuffer->renderSize[1]         = renderSize.y;
-
-                        device->Unmap(bd->pPixelConstantBuffer, 0);
-
-                        if (render_source->sampleType == ImGuiImageSampleType_Nearest)
-                        {
-                            device->PSGetSamplers(0, 1, &currentSampler);
-                            device->PSSetSamplers(0, 1, &bd->pNearestSampler);
-                        }
+                        srvs[i] = (ID3D11ShaderResourceView *)render_source->textureID[i];
+                    }
+
+                    device->PSSetShaderResources(0, planes, srvs);
+                    bound_srv = srvs[0];
+
+                    ZeroMemory(&mappedResource, sizeof(mappedResource));
+                    device->Map(bd->pPixelConstantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+                    constantBuffer                    = (PS_CONSTANT_BUFFER *)mappedResource.pData;
+                    constantBuffer->format            = getTextureFormat(render_source->imageFormat);
+                    constantBuffer->textureColorRange = render_source->colorRange;
+                    constantBuffer->textureColorSpace = render_source->colorSpace;
+                    constantBuffer->textureValueScale = getTextureValueScale(render_source->imageFormat);
+                    // the default sampler is trilinear, with a mip chain the area taps are not needed
+                    constantBuffer->useAreaSample =
+                        (render_source->sampleType == ImGuiImageSampleType_Area && !render_source->mipmaps ? 1 : 0);
+                    // printf("format: %d, colorRange: %d, useAreaSample: %d\n", constantBuffer->format,
+                    //        constantBuffer->textureColorRange, constantBuffer->useAreaSample);
+
+                    constantBuffer->textureSize[0]        = (float)render_source->width;
+                    constantBuffer->textureSize[1]        = (float)render_source->height;
+                    constantBuffer->textureShowingSize[0] = render_source->width * textureSize.x;
+                    constantBuffer->textureShowingSize[1] = render_source->height * textureSize.y;
+                    constantBuffer->renderSize[0]         = renderSize.x;
+                    constantBuffer->renderSize[1]         = renderSize.y;
+
+                    device->Unmap(bd->pPixelConstantBuffer, 0);
+
+                    if (render_source->sampleType == ImGuiImageSampleType_Nearest)
+                    {
+                        device->PSGetSamplers(0, 1, &currentSampler);
+                        device->PSSetSamplers(0, 1, &bd->pNearestSampler);
                     }
                 }
                 device->DrawIndexed(pcmd->ElemCount, pcmd->IdxOffset + global_idx_offset, pcmd->VtxOffset + global_vtx_offset);
@@ -788,6 +803,7 @@ void ImGui_ImplDX11_InvalidateDeviceObjects()
         bd->pPixelConstantBuffer->Release();
         bd->pPixelConstantBuffer = nullptr;
     }
+    ImGui::clearTexturePool();
 }
 
 bool ImGui_ImplDX11_Init(ID3D11Device *device, ID3D11DeviceContext *device_context)
@@ -1009,7 +1025,8 @@ static void ImGui_ImplDX11_ShutdownMultiViewportSupport()
             }                     \
         } while (0)
 
-int createImageTexture(ID3D11Texture2D **ptex, ID3D11ShaderResourceView **psrv, int texWidth, int texHeight, DXGI_FORMAT format)
+int createImageTexture(ID3D11Texture2D **ptex, ID3D11ShaderResourceView **psrv, int texWidth, int texHeight, DXGI_FORMAT format,
+                       bool mipmaps)
 {
     ImGui_ImplDX11_Data *bd = ImGui_ImplDX11_GetBackendData();
     if (!bd || !bd->pd3dDevice || !bd->pd3dDeviceContext)
@@ -1034,6 +1051,13 @@ int createImageTexture(ID3D11Texture2D **ptex, ID3D11ShaderResourceView **psrv,
     textureDesc.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
     textureDesc.CPUAccessFlags   = 0;
     textureDesc.MiscFlags        = 0;
+    if (mipmaps)
+    {
+        // full chain, filled by GenerateMips which needs the texture to be a render target
+        textureDesc.MipLevels = 0;
+        textureDesc.BindFlags |= D3D11_BIND_RENDER_TARGET;
+        textureDesc.MiscFlags |= D3D11_RESOURCE_MISC_GENERATE_MIPS;
+    }
 
     HRESULT hr = bd->pd3dDevice->CreateTexture2D(&textureDesc, 0, ptex);
     if (FAILED(hr))
@@ -1060,6 +1084,121 @@ int createImageTexture(ID3D11Texture2D **ptex, ID3D11ShaderResourceView **psrv,
 
 namespace ImGui
 {
+    struct PooledTexture
+    {
+        ID3D11ShaderResourceView *srv;
+        UINT                      width;
+        UINT                      height;
+        DXGI_FORMAT               format;
+        bool                      mipmaps;
+    };
+
+    // front is the least recently released
+    static std::vector<PooledTexture> gTexturePool;
+    static unsigned int               gTexturePoolCapacity = 16;
+    static uint64_t                   gTexturePoolHits     = 0;
+    static uint64_t                   gTexturePoolMisses   = 0;
+
+    static void trimTexturePool(unsigned int capacity)
+    {
+        while (gTexturePool.size() > capacity)
+        {
+            SAFE_RELEASE_RES(gTexturePool.front().srv);
+            gTexturePool.erase(gTexturePool.begin());
+        }
+    }
+
+    // return nullptr if nothing matches
+    static ID3D11ShaderResourceView *acquirePooledTexture(UINT width, UINT height, DXGI_FORMAT format, bool mipmaps)
+    {
+        for (size_t i = gTexturePool.size(); i-- > 0;)
+        {
+            PooledTexture &pooled = gTexturePool[i];
+            if (pooled.width == width && pooled.height == height && pooled.format == format && pooled.mipmaps == mipmaps)
+            {
+                ID3D11ShaderResourceView *srv = pooled.srv;
+                gTexturePool.erase(gTexturePool.begin() + i);
+                gTexturePoolHits++;
+                return srv;
+            }
+        }
+        gTexturePoolMisses++;
+        return nullptr;
+    }
+
+    // take over the reference of texSRV, views of shared NV12 textures are not pooled
+    static void releaseTextureView(ID3D11ShaderResourceView *texSRV)
+    {
+        if (!texSRV)
+            return;
+
+        ID3D11Texture2D *nativeTexture = nullptr;
+        texSRV->GetResource((ID3D11Resource **)&nativeTexture);
+        D3D11_TEXTURE2D_DESC desc;
+        ZeroMemory(&desc, sizeof(desc));
+        if (nativeTexture)
+            nativeTexture->GetDesc(&desc);
+        SAFE_RELEASE_RES(nativeTexture);
+
+        if (gTexturePoolCapacity == 0 || (desc.MiscFlags & D3D11_RESOURCE_MISC_SHARED) || desc.Format == DXGI_FORMAT_NV12
+            || desc.Format == DXGI_FORMAT_UNKNOWN)
+        {
+            SAFE_RELEASE_RES(texSRV);
+            return;
+        }
+
+        gTexturePool.push_back({texSRV, desc.Width, desc.Height, desc.Format, desc.MipLevels != 1});
+        trimTexturePool(gTexturePoolCapacity);
+    }
+
+    static DXGI_FORMAT getPlaneDXGIFormat(ImGuiImageFormat imageFormat, unsigned int bytesPerPixel)
+    {
+        static const DXGI_FORMAT formats8[]     = {DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_R8G8_UNORM, DXGI_FORMAT_UNKNOWN,
+                                                   DXGI_FORMAT_R8G8B8A8_UNORM};
+        static const DXGI_FORMAT formats16[]    = {DXGI_FORMAT_R16_UNORM, DXGI_FORMAT_R16G16_UNORM, DXGI_FORMAT_UNKNOWN,
+                                                   DXGI_FORMAT_R16G16B16A16_UNORM};
+        static const DXGI_FORMAT formatsFloat[] = {DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_UNKNOWN,
+                                                   DXGI_FORMAT_R32G32B32A32_FLOAT};
+
+        unsigned int componentBytes = getComponentBytes(imageFormat);
+        unsigned int components     = bytesPerPixel / componentBytes;
+        if (bytesPerPixel % componentBytes != 0 || components < 1 || components > 4)
+            return DXGI_FORMAT_UNKNOWN;
+
+        switch (componentBytes)
+        {
+            case 1:
+                return formats8[components - 1];
+            case 2:
+                return formats16[components - 1];
+            case 4:
+                return formatsFloat[components - 1];
+            default:
+                return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    void setTexturePoolCapacity(unsigned int textureCount)
+    {
+        gTexturePoolCapacity = textureCount;
+        trimTexturePool(gTexturePoolCapacity);
+    }
+
+    TexturePoolStats getTexturePoolStats()
+    {
+        TexturePoolStats stats;
+        stats.hits        = gTexturePoolHits;
+        stats.misses      = gTexturePoolMisses;
+        stats.pooledCount = (unsigned int)gTexturePool.size();
+        stats.capacity    = gTexturePoolCapacity;
+        return stats;
+    }
+
+    void clearTexturePool()
+    {
+        trimTexturePool(0);
+    }
+
     bool updateImageTexture(ImageData &image, TextureSource &texture)
     {
         ImGui_ImplDX11_Data *bd = ImGui_ImplDX11_GetBackendData();
@@ -1254,21 +1393,11 @@ namespace ImGui
                 unsigned int height        = 0;
                 getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
 
-                DXGI_FORMAT dxgiFormat;
-                switch (bytesPerPixel)
+                DXGI_FORMAT dxgiFormat = getPlaneDXGIFormat(image.format, bytesPerPixel);
+                if (dxgiFormat == DXGI_FORMAT_UNKNOWN)
                 {
-                    case 1:
-                        dxgiFormat = DXGI_FORMAT_R8_UNORM;
-                        break;
-                    case 2:
-                        dxgiFormat = DXGI_FORMAT_R8G8_UNORM;
-                        break;
-                    case 4:
-                        dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
-                        break;
-                    default:
-                        dbg("unsupported bytesPerPixel %d\n", bytesPerPixel);
-                        return false;
+                    dbg("unsupported bytesPerPixel %d\n", bytesPerPixel);
+                    return false;
                 }
 
                 if (texSRV)
@@ -1280,9 +1409,11 @@ namespace ImGui
 
                     D3D11_TEXTURE2D_DESC desc;
                     nativeTexture->GetDesc(&desc);
-                    if (desc.Width != (UINT)width || desc.Height != (UINT)height || desc.Format != dxgiFormat)
+                    if (desc.Width != (UINT)width || desc.Height != (UINT)height || desc.Format != dxgiFormat
+                        || (desc.MipLevels != 1) != texture.mipmaps)
                     {
-                        SAFE_RELEASE_RES(texSRV);
+                        releaseTextureView(texSRV);
+                        texSRV = nullptr;
                         SAFE_RELEASE_RES(nativeTexture);
                     }
                 } while (0);
@@ -1291,7 +1422,10 @@ namespace ImGui
                 {
                     SAFE_RELEASE_RES(texSRV);
                     SAFE_RELEASE_RES(nativeTexture);
-                    if (createImageTexture(&nativeTexture, &texSRV, width, height, dxgiFormat) < 0)
+                    texSRV = acquirePooledTexture(width, height, dxgiFormat, texture.mipmaps);
+                    if (texSRV)
+                        texSRV->GetResource((ID3D11Resource **)&nativeTexture);
+                    else if (createImageTexture(&nativeTexture, &texSRV, width, height, dxgiFormat, texture.mipmaps) < 0)
                     {
                         dbg("createImageTexture fail\n");
                         SAFE_RELEASE_RES(texSRV);
@@ -1301,6 +1435,8 @@ namespace ImGui
                 }
 
                 bd->pd3dDeviceContext->UpdateSubresource(nativeTexture, 0, 0, image.plane[i], (UINT)image.stride[i], 0);
+                if (texture.mipmaps)
+                    bd->pd3dDeviceContext->GenerateMips(texSRV);
 
                 texture.textureID[i] = (uintptr_t)texSRV;
                 SAFE_RELEASE_RES(nativeTexture);
@@ -1310,15 +1446,39 @@ namespace ImGui
         texture.width      = image.width;
         texture.height     = image.height;
         texture.colorRange = image.colorRange;
+        texture.colorSpace = image.colorSpace;
         return true;
     }
 
+    // UpdateSubresource already stages the copy in the driver, no pixel buffer ring here
+    bool mapImageTexture(TextureSource &texture, ImageData &image)
+    {
+        IM_UNUSED(texture);
+        IM_UNUSED(image);
+        dbg("texture streaming not supported by dx11 backend\n");
+        return false;
+    }
+
+    bool unmapImageTexture(TextureSource &texture)
+    {
+        IM_UNUSED(texture);
+        return false;
+    }
+
+    bool captureFrame(const FrameCaptureCallback &callback, ImVec2 regionPos, ImVec2 regionSize)
+    {
+        IM_UNUSED(callback);
+        IM_UNUSED(regionPos);
+        IM_UNUSED(regionSize);
+        dbg("frame capture not supported by dx11 backend\n");
+        return false;
+    }
+
     void freeTexture(TextureSource &texture)
     {
         for (int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
         {
-            ID3D11ShaderResourceView *texSRV = (ID3D11ShaderResourceView *)texture.textureID[i];
-            SAFE_RELEASE_RES(texSRV);
+            releaseTextureView((ID3D11ShaderResourceView *)texture.textureID[i]);
             texture.textureID[i] = 0;
         }
     }
@@ -98,6 +98,7 @@
 //  mapping for ImGuiKey_Insert. 2017-08-25: Inputs: MousePos set to -FLT_MAX,-FLT_MAX when mouse is unavailable/missing (instead
 //  of -1,-1). 2016-10-15: Misc: Added a void* user_data parameter to Clipboard function handlers.
 
+#include <atomic>
 #include <set>
 #include "imgui.h"
 #ifndef IMGUI_DISABLE
@@ -208,6 +209,7 @@ struct ImGui_ImplGlfw_Data
 };
 
 std::set<GLFWwindow *> gWindows;
+static std::atomic<bool> gMainLoopWakeable(false); // glfwPostEmptyEvent() needs glfw to be initialized
 
 // Backend data stored in io.BackendPlatformUserData to allow support for multiple Dear ImGui contexts
 // It is STRONGLY preferred that you use docking branch with multi-viewports (== single Dear ImGui context + multiple
@@ -756,6 +758,8 @@ static bool ImGui_ImplGlfw_Init(GLFWwindow *window, bool install_callbacks, Glfw
     // printf("GLFW_VERSION: %d.%d.%d (%d)", GLFW_VERSION_MAJOR, GLFW_VERSION_MINOR, GLFW_VERSION_REVISION,
     // GLFW_VERSION_COMBINED);
 
+    gMainLoopWakeable = true;
+
     // Setup backend capabilities flags
     ImGui_ImplGlfw_Data *bd    = IM_NEW(ImGui_ImplGlfw_Data)();
     io.BackendPlatformUserData = (void *)bd;
@@ -855,6 +859,8 @@ void ImGui_ImplGlfw_Shutdown()
     IM_ASSERT(bd != nullptr && "No platform backend to shutdown, or already shutdown?");
     ImGuiIO &io = ImGui::GetIO();
 
+    gMainLoopWakeable = false;
+
     ImGui_ImplGlfw_ShutdownMultiViewportSupport();
 
     if (bd->InstalledCallbacks)
@@ -1724,6 +1730,12 @@ namespace ImGui
         glfwSetWindowTitle(bd->Window, title.c_str());
     }
 
+    void wakeMainLoop()
+    {
+        if (gMainLoopWakeable)
+            glfwPostEmptyEvent();
+    }
+
     ImRect getWindowRect()
     {
         GLFWwindow *window = getMainWindow();
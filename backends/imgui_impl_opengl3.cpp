@@ -25,7 +25,13 @@
 #ifndef IMGUI_DISABLE
     #include "imgui_impl_opengl3.h"
     #include <stdio.h>
+    #include <stdlib.h> // qsort
     #include <stdint.h> // intptr_t
+    #include <math.h>   // NAN
+    #include <condition_variable>
+    #include <deque>
+    #include <thread>
+    #include <unordered_map>
     #if defined(__APPLE__)
         #include <TargetConditionals.h>
     #endif
@@ -68,6 +74,60 @@
 
 using namespace ImGui;
 
+// Last state set by the render loop, -1 (or NaN for floats) when unknown
+struct ImGui_ImplOpenGL3_StateCache
+{
+    GLint  ActiveUnit;
+    GLuint Texture[IMGUI_IMAGE_MAX_PLANES];
+    GLuint Sampler[IMGUI_IMAGE_MAX_PLANES];
+    GLint  TexFormat;
+    GLint  TexColorRange;
+    GLint  TexColorSpace;
+    GLint  UseAreaSample;
+    float  TexValueScale;
+    ImVec2 TextureSize;
+    ImVec2 TextureShowingSize;
+    ImVec2 RenderSize;
+
+    void Invalidate()
+    {
+        ActiveUnit = -1;
+        for (int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
+        {
+            Texture[i] = (GLuint)-1;
+            Sampler[i] = (GLuint)-1;
+        }
+        TexFormat          = -1;
+        TexColorRange      = -1;
+        TexColorSpace      = -1;
+        UseAreaSample      = -1;
+        TexValueScale      = NAN;
+        TextureSize        = ImVec2(NAN, NAN);
+        TextureShowingSize = ImVec2(NAN, NAN);
+        RenderSize         = ImVec2(NAN, NAN);
+    }
+};
+
+    #define IMGUI_IMPL_OPENGL_GPU_TIMER_FRAMES  4   // frames a query result can take before it is dropped
+    #define IMGUI_IMPL_OPENGL_GPU_TIMER_QUERIES 256 // per frame, further draw lists are not timed
+
+// One GL_TIME_ELAPSED query, a draw list is split in several of them when its image commands are timed apart
+struct ImGui_ImplOpenGL3_GpuTimerQuery
+{
+    int  DrawList; // index in ImGui_ImplOpenGL3_GpuTimerFrame::DrawLists
+    bool IsImage;
+};
+
+// Queries issued in one frame, resolved once the last one is available
+struct ImGui_ImplOpenGL3_GpuTimerFrame
+{
+    GLuint                                Queries[IMGUI_IMPL_OPENGL_GPU_TIMER_QUERIES];
+    ImGui_ImplOpenGL3_GpuTimerQuery       Info[IMGUI_IMPL_OPENGL_GPU_TIMER_QUERIES];
+    int                                   Count;
+    bool                                  Pending;
+    ImVector<ImGui_ImplOpenGL3_GpuTiming> DrawLists;
+};
+
 // OpenGL Data
 struct ImGui_ImplOpenGL3_Data
 {
@@ -83,10 +143,13 @@ struct ImGui_ImplOpenGL3_Data
     GLint        AttribLocationTex[3]; // Uniforms location
     GLint        AttribLocationTexFormat;
     GLint        AttribLocationTexColorRange;
+    GLint        AttribLocationTexColorSpace;
+    GLint        AttribLocationTexValueScale;
     GLint        AttribLocationTextureSize;
     GLint        AttribLocationTextureShowingSize;
     GLint        AttribLocationRenderSize;
     GLint        AttribLocationUseAreaSample;
+    GLuint       Samplers[ImGuiImageSampleType_Max]; // Area is the trilinear one, used by mipmapped images
 
     GLint        AttribLocationProjMtx;
     GLuint       AttribLocationVtxPos; // Vertex attributes location
@@ -97,8 +160,21 @@ struct ImGui_ImplOpenGL3_Data
     GLsizeiptr   IndexBufferSize;
     bool         HasPolygonMode;
     bool         HasClipOrigin;
+    bool         HasSamplerObjects;
+    bool         HasTimerQueries;
     bool         UseBufferSubData;
 
+    ImGui_ImplOpenGL3_StateCache StateCache;
+    ImGui_ImplOpenGL3_StateStats StateStats;     // counted during the current frame
+    ImGui_ImplOpenGL3_StateStats LastStateStats; // of the previous frame
+
+    bool                                  GpuTimersEnabled;
+    bool                                  GpuTimeImages;
+    bool                                  GpuTimerActive; // a query is begun and not ended yet
+    int                                   GpuTimerFrame;  // slot recorded in the current frame
+    ImGui_ImplOpenGL3_GpuTimerFrame       GpuTimerFrames[IMGUI_IMPL_OPENGL_GPU_TIMER_FRAMES];
+    ImVector<ImGui_ImplOpenGL3_GpuTiming> GpuTimings; // of the latest frame resolved
+
     ImGui_ImplOpenGL3_Data() { memset((void *)this, 0, sizeof(*this)); }
 };
 
@@ -113,6 +189,13 @@ static ImGui_ImplOpenGL3_Data *ImGui_ImplOpenGL3_GetBackendData()
 // Forward Declarations
 static void ImGui_ImplOpenGL3_InitMultiViewportSupport();
 static void ImGui_ImplOpenGL3_ShutdownMultiViewportSupport();
+static void ImGui_ImplOpenGL3_NewGpuTimerFrame(ImGui_ImplOpenGL3_Data *bd);
+namespace ImGui
+{
+    static void readFrameCaptures(ImDrawData *drawData, int fbWidth, int fbHeight);
+    static void pollFrameCaptures();
+    static void freeFrameCaptures();
+} // namespace ImGui
 
 // Functions
 bool ImGui_ImplOpenGL3_Init(const char *glsl_version)
@@ -207,6 +290,8 @@ bool ImGui_ImplOpenGL3_Init(const char *glsl_version)
     // Detect extensions we support
     bd->HasPolygonMode = (!bd->GlProfileIsES2 && !bd->GlProfileIsES3);
     bd->HasClipOrigin  = (bd->GlVersion >= 450);
+    bd->HasSamplerObjects = (bd->GlVersion >= 330 || bd->GlProfileIsES3);
+    bd->HasTimerQueries   = (bd->GlVersion >= 330 && !bd->GlProfileIsES2 && !bd->GlProfileIsES3);
 
     GLint num_extensions = 0;
     glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
@@ -229,6 +314,7 @@ void ImGui_ImplOpenGL3_Shutdown()
     ImGuiIO &io = ImGui::GetIO();
 
     ImGui_ImplOpenGL3_ShutdownMultiViewportSupport();
+    ImGui::freeFrameCaptures();
     ImGui_ImplOpenGL3_DestroyDeviceObjects();
     io.BackendRendererName     = nullptr;
     io.BackendRendererUserData = nullptr;
@@ -245,6 +331,234 @@ void ImGui_ImplOpenGL3_NewFrame()
         ImGui_ImplOpenGL3_CreateDeviceObjects();
     if (!bd->FontTexture)
         ImGui_ImplOpenGL3_CreateFontsTexture();
+
+    bd->LastStateStats = bd->StateStats;
+    bd->StateStats     = ImGui_ImplOpenGL3_StateStats();
+
+    ImGui_ImplOpenGL3_NewGpuTimerFrame(bd);
+    ImGui::pollFrameCaptures();
+}
+
+ImGui_ImplOpenGL3_StateStats ImGui_ImplOpenGL3_GetStateStats()
+{
+    ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
+    return bd ? bd->LastStateStats : ImGui_ImplOpenGL3_StateStats();
+}
+
+// GPU timers
+// A ring of IMGUI_IMPL_OPENGL_GPU_TIMER_FRAMES frames of queries. Each NewFrame() reads the frames whose last query is
+// available, oldest first, and stops at the first one still in flight. A frame not resolved when its slot comes back is
+// dropped. Timer queries can not nest, so the query of a draw list is ended around a timed image command and a new one
+// is begun after it.
+void ImGui_ImplOpenGL3_SetGpuTimersEnabled(bool enabled, bool time_image_commands)
+{
+    ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (!bd)
+        return;
+    bd->GpuTimersEnabled = enabled && bd->HasTimerQueries;
+    bd->GpuTimeImages    = time_image_commands;
+    if (!bd->GpuTimersEnabled)
+        bd->GpuTimings.clear();
+}
+
+bool ImGui_ImplOpenGL3_GpuTimersEnabled()
+{
+    ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
+    return bd && bd->GpuTimersEnabled;
+}
+
+bool ImGui_ImplOpenGL3_GpuTimersSupported()
+{
+    ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
+    return bd && bd->HasTimerQueries;
+}
+
+int ImGui_ImplOpenGL3_GetGpuTimings(const ImGui_ImplOpenGL3_GpuTiming **out_timings)
+{
+    ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (!bd || bd->GpuTimings.empty())
+    {
+        *out_timings = nullptr;
+        return 0;
+    }
+    *out_timings = bd->GpuTimings.Data;
+    return bd->GpuTimings.Size;
+}
+
+static int ImGui_ImplOpenGL3_CompareGpuTiming(const void *lhs, const void *rhs)
+{
+    float a = ((const ImGui_ImplOpenGL3_GpuTiming *)lhs)->TotalMs;
+    float b = ((const ImGui_ImplOpenGL3_GpuTiming *)rhs)->TotalMs;
+    return a < b ? 1 : (a > b ? -1 : 0);
+}
+
+// return false if the results are not available yet
+static bool ImGui_ImplOpenGL3_ResolveGpuTimerFrame(ImGui_ImplOpenGL3_Data *bd, ImGui_ImplOpenGL3_GpuTimerFrame &frame)
+{
+    #if defined(GL_TIME_ELAPSED)
+    if (frame.Count > 0)
+    {
+        // queries finish in submission order, the last one available means all of them are
+        GLint available = 0;
+        glGetQueryObjectiv(frame.Queries[frame.Count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+
+        for (int i = 0; i < frame.Count; i++)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &elapsed);
+            ImGui_ImplOpenGL3_GpuTiming &draw_list = frame.DrawLists[frame.Info[i].DrawList];
+            float                        ms        = (float)(elapsed / 1e6);
+            draw_list.TotalMs += ms;
+            if (frame.Info[i].IsImage)
+                draw_list.ImageMs += ms;
+        }
+        qsort(frame.DrawLists.Data, (size_t)frame.DrawLists.Size, sizeof(ImGui_ImplOpenGL3_GpuTiming),
+              ImGui_ImplOpenGL3_CompareGpuTiming);
+        if (bd->GpuTimersEnabled)
+            bd->GpuTimings.swap(frame.DrawLists);
+    }
+    #else
+    IM_UNUSED(bd);
+    #endif
+    frame.Pending = false;
+    return true;
+}
+
+static void ImGui_ImplOpenGL3_NewGpuTimerFrame(ImGui_ImplOpenGL3_Data *bd)
+{
+    if (!bd->GpuTimerFrames[0].Queries[0])
+        return;
+
+    for (int i = 1; i <= IMGUI_IMPL_OPENGL_GPU_TIMER_FRAMES; i++)
+    {
+        ImGui_ImplOpenGL3_GpuTimerFrame &frame = bd->GpuTimerFrames[(bd->GpuTimerFrame + i) % IMGUI_IMPL_OPENGL_GPU_TIMER_FRAMES];
+        if (frame.Pending && !ImGui_ImplOpenGL3_ResolveGpuTimerFrame(bd, frame))
+            break;
+    }
+
+    // the slot of the oldest frame is reused, its results are dropped if the GPU is still behind
+    bd->GpuTimerFrame                      = (bd->GpuTimerFrame + 1) % IMGUI_IMPL_OPENGL_GPU_TIMER_FRAMES;
+    ImGui_ImplOpenGL3_GpuTimerFrame &frame = bd->GpuTimerFrames[bd->GpuTimerFrame];
+    frame.Count                            = 0;
+    frame.Pending                          = bd->GpuTimersEnabled;
+    frame.DrawLists.resize(0);
+}
+
+// a draw list is rendered once per frame, return the index of its new entry
+static int ImGui_ImplOpenGL3_AddGpuTimerDrawList(ImGui_ImplOpenGL3_GpuTimerFrame &frame, const ImDrawList *draw_list)
+{
+    ImGui_ImplOpenGL3_GpuTiming timing;
+    memset(&timing, 0, sizeof(timing));
+    timing.DrawList = draw_list;
+    frame.DrawLists.push_back(timing);
+    return frame.DrawLists.Size - 1;
+}
+
+static void ImGui_ImplOpenGL3_BeginGpuTimer(ImGui_ImplOpenGL3_Data *bd, int draw_list, bool is_image)
+{
+    #if defined(GL_TIME_ELAPSED)
+    ImGui_ImplOpenGL3_GpuTimerFrame &frame = bd->GpuTimerFrames[bd->GpuTimerFrame];
+    if (bd->GpuTimerActive || frame.Count >= IMGUI_IMPL_OPENGL_GPU_TIMER_QUERIES)
+        return;
+    frame.Info[frame.Count].DrawList = draw_list;
+    frame.Info[frame.Count].IsImage  = is_image;
+    glBeginQuery(GL_TIME_ELAPSED, frame.Queries[frame.Count]);
+    frame.Count++;
+    bd->GpuTimerActive = true;
+    #else
+    IM_UNUSED(bd);
+    IM_UNUSED(draw_list);
+    IM_UNUSED(is_image);
+    #endif
+}
+
+static void ImGui_ImplOpenGL3_EndGpuTimer(ImGui_ImplOpenGL3_Data *bd)
+{
+    #if defined(GL_TIME_ELAPSED)
+    if (!bd->GpuTimerActive)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    bd->GpuTimerActive = false;
+    #else
+    IM_UNUSED(bd);
+    #endif
+}
+
+// Cached state setters used by the render loop, each call either reaches GL or is counted as skipped
+static void ImGui_ImplOpenGL3_SetActiveUnit(ImGui_ImplOpenGL3_Data *bd, int unit)
+{
+    if (bd->StateCache.ActiveUnit == unit)
+    {
+        bd->StateStats.SkippedCalls++;
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    bd->StateCache.ActiveUnit = unit;
+    bd->StateStats.IssuedCalls++;
+}
+
+static void ImGui_ImplOpenGL3_BindTexture(ImGui_ImplOpenGL3_Data *bd, int unit, GLuint texture)
+{
+    if (bd->StateCache.Texture[unit] == texture)
+    {
+        bd->StateStats.SkippedCalls++;
+        return;
+    }
+    ImGui_ImplOpenGL3_SetActiveUnit(bd, unit);
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+    bd->StateCache.Texture[unit] = texture;
+    bd->StateStats.IssuedCalls++;
+}
+
+static void ImGui_ImplOpenGL3_BindSampler(ImGui_ImplOpenGL3_Data *bd, int unit, ImGuiImageSampleType sampleType)
+{
+    GLuint sampler = bd->Samplers[sampleType];
+    if (bd->StateCache.Sampler[unit] == sampler)
+    {
+        bd->StateStats.SkippedCalls++;
+        return;
+    }
+    GL_CALL(glBindSampler(unit, sampler));
+    bd->StateCache.Sampler[unit] = sampler;
+    bd->StateStats.IssuedCalls++;
+}
+
+static void ImGui_ImplOpenGL3_Uniform1i(ImGui_ImplOpenGL3_Data *bd, GLint location, GLint &cached, GLint value)
+{
+    if (cached == value)
+    {
+        bd->StateStats.SkippedCalls++;
+        return;
+    }
+    glUniform1i(location, value);
+    cached = value;
+    bd->StateStats.IssuedCalls++;
+}
+
+static void ImGui_ImplOpenGL3_Uniform1f(ImGui_ImplOpenGL3_Data *bd, GLint location, float &cached, float value)
+{
+    if (cached == value)
+    {
+        bd->StateStats.SkippedCalls++;
+        return;
+    }
+    glUniform1f(location, value);
+    cached = value;
+    bd->StateStats.IssuedCalls++;
+}
+
+static void ImGui_ImplOpenGL3_Uniform2f(ImGui_ImplOpenGL3_Data *bd, GLint location, ImVec2 &cached, ImVec2 value)
+{
+    if (cached.x == value.x && cached.y == value.y)
+    {
+        bd->StateStats.SkippedCalls++;
+        return;
+    }
+    glUniform2f(location, value.x, value.y);
+    cached = value;
+    bd->StateStats.IssuedCalls++;
 }
 
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData *draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
@@ -325,6 +639,9 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData *draw_data, int fb_wid
                                   (GLvoid *)offsetof(ImDrawVert, uv)));
     GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert),
                                   (GLvoid *)offsetof(ImDrawVert, col)));
+
+    // the program may have been used by another context or viewport since
+    bd->StateCache.Invalidate();
 }
 
 // OpenGL3 Render function.
@@ -406,11 +723,22 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData *draw_data)
     ImVec2 clip_off   = draw_data->DisplayPos;       // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
+    // the queries belong to the main context, the other viewports render with their own
+    bool time_gpu = bd->GpuTimersEnabled && bd->GpuTimerFrames[bd->GpuTimerFrame].Pending &&
+                    draw_data->OwnerViewport == ImGui::GetMainViewport();
+
     // Render command lists
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList *draw_list = draw_data->CmdLists[n];
 
+        int gpu_draw_list = -1;
+        if (time_gpu)
+        {
+            gpu_draw_list = ImGui_ImplOpenGL3_AddGpuTimerDrawList(bd->GpuTimerFrames[bd->GpuTimerFrame], draw_list);
+            ImGui_ImplOpenGL3_BeginGpuTimer(bd, gpu_draw_list, false);
+        }
+
         // Upload vertex/index buffers
         // - OpenGL drivers are in a very sorry state nowadays....
         //   During 2021 we attempted to switch from glBufferData() to orphaning+glBufferSubData() following reports
@@ -445,6 +773,7 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData *draw_data)
                                  GL_STREAM_DRAW));
         }
 
+        RenderSource *image_source = nullptr; // set by ImDrawCallback_ImageCommand for the next command
         for (int cmd_i = 0; cmd_i < draw_list->CmdBuffer.Size; cmd_i++)
         {
             const ImDrawCmd *pcmd = &draw_list->CmdBuffer[cmd_i];
@@ -453,13 +782,24 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData *draw_data)
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer
                 // to reset render state.)
+                if (pcmd->UserCallback == ImDrawCallback_ImageCommand)
+                {
+                    image_source = (RenderSource *)pcmd->UserCallbackData;
+                    continue;
+                }
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
                     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
                 else
+                {
                     pcmd->UserCallback(draw_list, pcmd);
+                    bd->StateCache.Invalidate();
+                }
             }
             else
             {
+                RenderSource *image = image_source;
+                image_source        = nullptr;
+
                 // Project scissor/clipping rectangles into framebuffer space
                 ImVec2 clip_min((pcmd->ClipRect.x - clip_off.x) * clip_scale.x, (pcmd->ClipRect.y - clip_off.y) * clip_scale.y);
                 ImVec2 clip_max((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, (pcmd->ClipRect.w - clip_off.y) * clip_scale.y);
@@ -472,55 +812,81 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData *draw_data)
 
                 // Bind texture, Draw
                 RenderSource *render_source = (RenderSource *)pcmd->GetTexID();
-                GLuint        texture       = 0;
-                if (render_source)
-                    texture = (GLuint)(render_source->textureID[0]);
-                glActiveTexture(GL_TEXTURE0);
-                GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
-                GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-                GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-                glUniform1i(bd->AttribLocationTexFormat, -1);
-
-                if (pcmd->ElemCount == 6) // maybe is a picture
+                ImVec2        texturePos, textureSize;
+                ImVec2        renderPos, renderSize;
+                ImGui_ImplOpenGL3_StateCache &cache = bd->StateCache;
+                if (!image && render_source && needsImageShader(*render_source))
+                    image = render_source;
+                if (!getImageCommandRect(draw_list, pcmd, image, texturePos, textureSize, renderPos, renderSize))
                 {
-                    ImDrawVert vertices[6];
-                    auto      *pVertices = draw_list->VtxBuffer.Data + pcmd->VtxOffset;
-                    auto      *indices   = draw_list->IdxBuffer.Data + pcmd->IdxOffset;
-                    for (int i = 0; i < 6; i++)
-                    {
-                        int idx     = indices[i];
-                        vertices[i] = pVertices[idx];
-                    }
-                    ImVec2 texturePos, textureSize;
-                    ImVec2 renderPos, renderSize;
-                    if (checkTextureRect(vertices, texturePos, textureSize, renderPos, renderSize)
-                        && (render_source->imageFormat != ImGui::ImGuiImageFormat_RGBA
-                            || render_source->sampleType != ImGui::ImGuiImageSampleType_Linear))
+                    // plain ImGui geometry, mostly the font atlas
+                    GLuint texture = 0;
+                    if (render_source)
+                        texture = (GLuint)(render_source->textureID[0]);
+                    ImGui_ImplOpenGL3_Uniform1i(bd, bd->AttribLocationTexFormat, cache.TexFormat, -1);
+                    ImGui_ImplOpenGL3_BindTexture(bd, 0, texture);
+                    if (bd->HasSamplerObjects)
+                        ImGui_ImplOpenGL3_BindSampler(bd, 0, ImGuiImageSampleType_Linear);
+                }
+                else
+                {
+                    ImGui_ImplOpenGL3_Uniform1i(bd, bd->AttribLocationTexFormat, cache.TexFormat,
+                                                getTextureFormat(render_source->imageFormat));
+                    ImGui_ImplOpenGL3_Uniform1i(bd, bd->AttribLocationTexColorRange, cache.TexColorRange,
+                                                render_source->colorRange);
+                    ImGui_ImplOpenGL3_Uniform1i(bd, bd->AttribLocationTexColorSpace, cache.TexColorSpace,
+                                                render_source->colorSpace);
+                    ImGui_ImplOpenGL3_Uniform1f(bd, bd->AttribLocationTexValueScale, cache.TexValueScale,
+                                                getTextureValueScale(render_source->imageFormat));
+                    ImGui_ImplOpenGL3_Uniform2f(bd, bd->AttribLocationTextureSize, cache.TextureSize,
+                                                ImVec2((float)render_source->width, (float)render_source->height));
+                    ImGui_ImplOpenGL3_Uniform2f(
+                        bd, bd->AttribLocationTextureShowingSize, cache.TextureShowingSize,
+                        ImVec2(textureSize.x * render_source->width, textureSize.y * render_source->height));
+                    ImGui_ImplOpenGL3_Uniform2f(bd, bd->AttribLocationRenderSize, cache.RenderSize, renderSize);
+                    // with a mip chain the hardware picks the level, the area taps are not needed
+                    bool useAreaSample =
+                        render_source->sampleType == ImGui::ImGuiImageSampleType_Area && !render_source->mipmaps;
+                    ImGui_ImplOpenGL3_Uniform1i(bd, bd->AttribLocationUseAreaSample, cache.UseAreaSample, useAreaSample ? 1 : 0);
+
+                    // trilinear when minified, level 0 is used as soon as the image is magnified
+                    ImGuiImageSampleType samplerType = ImGuiImageSampleType_Linear;
+                    if (render_source->sampleType == ImGui::ImGuiImageSampleType_Nearest)
+                        samplerType = ImGuiImageSampleType_Nearest;
+                    else if (render_source->mipmaps)
+                        samplerType = ImGuiImageSampleType_Area;
+                    for (int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
                     {
-                        glUniform1i(bd->AttribLocationTexFormat, getTextureFormat(render_source->imageFormat));
-                        glUniform1i(bd->AttribLocationTexColorRange, render_source->colorRange);
-                        glUniform2f(bd->AttribLocationTextureSize, (float)render_source->width, (float)render_source->height);
-                        glUniform2f(bd->AttribLocationTextureShowingSize, textureSize.x * render_source->width,
-                                    textureSize.y * render_source->height);
-                        glUniform2f(bd->AttribLocationRenderSize, renderSize.x, renderSize.y);
-                        glUniform1i(bd->AttribLocationUseAreaSample,
-                                    render_source->sampleType == ImGui::ImGuiImageSampleType_Area ? 1 : 0);
-
-                        for (int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
+                        if (render_source->textureID[i] == 0)
+                            continue;
+                        ImGui_ImplOpenGL3_BindTexture(bd, i, (GLuint)render_source->textureID[i]);
+                        if (bd->HasSamplerObjects)
+                        {
+                            ImGui_ImplOpenGL3_BindSampler(bd, i, samplerType);
+                        }
+                        else
                         {
-                            if (render_source->textureID[i] == 0)
-                                continue;
-                            glActiveTexture(GL_TEXTURE0 + i);
-                            glBindTexture(GL_TEXTURE_2D, (GLuint)render_source->textureID[i]);
-                            if (render_source->sampleType == ImGui::ImGuiImageSampleType_Nearest)
-                            {
-                                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-                                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-                            }
+                            GLint minFilter = samplerType == ImGuiImageSampleType_Nearest ? GL_NEAREST : GL_LINEAR;
+                            if (samplerType == ImGuiImageSampleType_Area)
+                                minFilter = GL_LINEAR_MIPMAP_LINEAR;
+                            ImGui_ImplOpenGL3_SetActiveUnit(bd, i);
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                                            samplerType == ImGuiImageSampleType_Nearest ? GL_NEAREST : GL_LINEAR);
+                            bd->StateStats.IssuedCalls += 2;
                         }
                     }
                 }
 
+                if (gpu_draw_list >= 0 && image)
+                    bd->GpuTimerFrames[bd->GpuTimerFrame].DrawLists[gpu_draw_list].ImageCommands++;
+                bool time_image = gpu_draw_list >= 0 && bd->GpuTimeImages && image != nullptr;
+                if (time_image)
+                {
+                    ImGui_ImplOpenGL3_EndGpuTimer(bd);
+                    ImGui_ImplOpenGL3_BeginGpuTimer(bd, gpu_draw_list, true);
+                }
+
                 if (bd->GlVersion >= 320)
                     GL_CALL(glDrawElementsBaseVertex(
                         GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
@@ -529,10 +895,21 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData *draw_data)
                     GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount,
                                            sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
                                            (void *)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx))));
+
+                if (time_image)
+                {
+                    ImGui_ImplOpenGL3_EndGpuTimer(bd);
+                    ImGui_ImplOpenGL3_BeginGpuTimer(bd, gpu_draw_list, false);
+                }
             }
         }
+        ImGui_ImplOpenGL3_EndGpuTimer(bd);
     }
 
+    // the main viewport is complete in the bound framebuffer
+    if (draw_data->OwnerViewport == ImGui::GetMainViewport())
+        ImGui::readFrameCaptures(draw_data, fb_width, fb_height);
+
     // Destroy the temporary VAO
     GL_CALL(glDeleteVertexArrays(1, &vertex_array_object));
 
@@ -541,9 +918,18 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData *draw_data)
     // backup, it will have been deleted by now and will cause an OpenGL error. See #6220.
     if (last_program == 0 || glIsProgram(last_program))
         glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-    if (bd->GlVersion >= 330 || bd->GlProfileIsES3)
+    if (bd->HasSamplerObjects)
+    {
+        // the image planes bind samplers beyond unit 0
+        for (int i = 1; i < IMGUI_IMAGE_MAX_PLANES; i++)
+        {
+            if (bd->StateCache.Sampler[i] != 0 && bd->StateCache.Sampler[i] != (GLuint)-1)
+                glBindSampler(i, 0);
+        }
         glBindSampler(0, last_sampler);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, last_texture);
     glActiveTexture(last_active_texture);
     glBindVertexArray(last_vertex_array_object);
     glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
@@ -767,6 +1153,8 @@ void main()
     }
     bd->AttribLocationTexFormat          = glGetUniformLocation(bd->ShaderHandle, "TextureFormat");
     bd->AttribLocationTexColorRange      = glGetUniformLocation(bd->ShaderHandle, "TextureColorRange");
+    bd->AttribLocationTexColorSpace      = glGetUniformLocation(bd->ShaderHandle, "TextureColorSpace");
+    bd->AttribLocationTexValueScale      = glGetUniformLocation(bd->ShaderHandle, "TextureValueScale");
     bd->AttribLocationTextureShowingSize = glGetUniformLocation(bd->ShaderHandle, "TextureShowingSize");
     bd->AttribLocationTextureSize        = glGetUniformLocation(bd->ShaderHandle, "TextureSize");
     bd->AttribLocationRenderSize         = glGetUniformLocation(bd->ShaderHandle, "RenderSize");
@@ -781,6 +1169,33 @@ void main()
     glGenBuffers(1, &bd->VboHandle);
     glGenBuffers(1, &bd->ElementsHandle);
 
+    // Create samplers, images are filtered by them instead of per texture parameters
+    if (bd->HasSamplerObjects)
+    {
+        const GLint minFilters[ImGuiImageSampleType_Max] = {GL_LINEAR, GL_NEAREST, GL_LINEAR_MIPMAP_LINEAR};
+        const GLint magFilters[ImGuiImageSampleType_Max] = {GL_LINEAR, GL_NEAREST, GL_LINEAR};
+        glGenSamplers(ImGuiImageSampleType_Max, bd->Samplers);
+        for (int i = 0; i < ImGuiImageSampleType_Max; i++)
+        {
+            glSamplerParameteri(bd->Samplers[i], GL_TEXTURE_MIN_FILTER, minFilters[i]);
+            glSamplerParameteri(bd->Samplers[i], GL_TEXTURE_MAG_FILTER, magFilters[i]);
+            glSamplerParameteri(bd->Samplers[i], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glSamplerParameteri(bd->Samplers[i], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+    }
+
+    #if defined(GL_TIME_ELAPSED)
+    if (bd->HasTimerQueries)
+    {
+        for (auto &frame : bd->GpuTimerFrames)
+        {
+            glGenQueries(IMGUI_IMPL_OPENGL_GPU_TIMER_QUERIES, frame.Queries);
+            frame.Count   = 0;
+            frame.Pending = false;
+        }
+    }
+    #endif
+
     ImGui_ImplOpenGL3_CreateFontsTexture();
 
     // Restore modified GL state
@@ -815,6 +1230,23 @@ void ImGui_ImplOpenGL3_DestroyDeviceObjects()
         glDeleteProgram(bd->ShaderHandle);
         bd->ShaderHandle = 0;
     }
+    if (bd->Samplers[0])
+    {
+        glDeleteSamplers(ImGuiImageSampleType_Max, bd->Samplers);
+        memset(bd->Samplers, 0, sizeof(bd->Samplers));
+    }
+    #if defined(GL_TIME_ELAPSED)
+    if (bd->GpuTimerFrames[0].Queries[0])
+    {
+        for (auto &frame : bd->GpuTimerFrames)
+        {
+            glDeleteQueries(IMGUI_IMPL_OPENGL_GPU_TIMER_QUERIES, frame.Queries);
+            memset(frame.Queries, 0, sizeof(frame.Queries));
+        }
+    }
+    #endif
+    bd->GpuTimings.clear();
+    ImGui::clearTexturePool();
     ImGui_ImplOpenGL3_DestroyFontsTexture();
 }
 
@@ -850,6 +1282,217 @@ static void ImGui_ImplOpenGL3_ShutdownMultiViewportSupport()
 namespace ImGui
 {
 
+    static bool getPlaneGLFormat(ImGuiImageFormat imageFormat, unsigned int bytesPerPixel, GLint *internalFormat, GLenum *format,
+                                 GLenum *type)
+    {
+        static const GLenum formats[]      = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+        static const GLint  formats8[]     = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+        static const GLint  formats16[]    = {GL_R16, GL_RG16, GL_RGB16, GL_RGBA16};
+        static const GLint  formatsFloat[] = {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F};
+
+        unsigned int componentBytes = getComponentBytes(imageFormat);
+        unsigned int components     = bytesPerPixel / componentBytes;
+        if (bytesPerPixel % componentBytes != 0 || components < 1 || components > 4)
+            return false;
+
+        *format = formats[components - 1];
+        switch (componentBytes)
+        {
+            case 1:
+                *internalFormat = formats8[components - 1];
+                *type           = GL_UNSIGNED_BYTE;
+                return true;
+            case 2:
+                // normalized, the full 16bit range maps to 0~1
+                *internalFormat = formats16[components - 1];
+                *type           = GL_UNSIGNED_SHORT;
+                return true;
+            case 4:
+                *internalFormat = formatsFloat[components - 1];
+                *type           = GL_FLOAT;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // largest GL_UNPACK_ALIGNMENT both the row start and the stride satisfy
+    static GLint getUnpackAlignment(const uint8_t *data, unsigned int stride)
+    {
+        uintptr_t bits = (uintptr_t)data | stride;
+        if ((bits & 7) == 0)
+            return 8;
+        if ((bits & 3) == 0)
+            return 4;
+        if ((bits & 1) == 0)
+            return 2;
+        return 1;
+    }
+
+    struct PooledTexture
+    {
+        GLuint  id;
+        GLsizei width;
+        GLsizei height;
+        GLint   internalFormat;
+    };
+
+    // front is the least recently released
+    static std::vector<PooledTexture> gTexturePool;
+    static unsigned int               gTexturePoolCapacity = 16;
+    static uint64_t                   gTexturePoolHits     = 0;
+    static uint64_t                   gTexturePoolMisses   = 0;
+    // storage each plane texture was really allocated with, by texture name, so pooling does not rely on the
+    // geometry recorded in a TextureSource which may describe a different or half prepared image
+    static std::unordered_map<GLuint, PooledTexture> gPlaneAllocations;
+
+    static void trimTexturePool(unsigned int capacity)
+    {
+        while (gTexturePool.size() > capacity)
+        {
+            gPlaneAllocations.erase(gTexturePool.front().id);
+            GL_CALL(glDeleteTextures(1, &gTexturePool.front().id));
+            gTexturePool.erase(gTexturePool.begin());
+        }
+    }
+
+    // return 0 if nothing matches
+    static GLuint acquirePooledTexture(GLsizei width, GLsizei height, GLint internalFormat)
+    {
+        for (size_t i = gTexturePool.size(); i-- > 0;)
+        {
+            PooledTexture &pooled = gTexturePool[i];
+            if (pooled.width == width && pooled.height == height && pooled.internalFormat == internalFormat)
+            {
+                GLuint id = pooled.id;
+                gTexturePool.erase(gTexturePool.begin() + i);
+                gTexturePoolHits++;
+                return id;
+            }
+        }
+        gTexturePoolMisses++;
+        return 0;
+    }
+
+    // give up one plane of texture, it is pooled under the storage it was allocated with
+    static void releasePlaneTexture(TextureSource &texture, unsigned int plane)
+    {
+        GLuint texID = (GLuint)texture.textureID[plane];
+        if (texID == 0)
+            return;
+        texture.textureID[plane] = 0;
+
+        auto allocation = gPlaneAllocations.find(texID);
+        if (gTexturePoolCapacity == 0 || allocation == gPlaneAllocations.end())
+        {
+            if (allocation != gPlaneAllocations.end())
+                gPlaneAllocations.erase(allocation);
+            GL_CALL(glDeleteTextures(1, &texID));
+            return;
+        }
+
+        gTexturePool.push_back(allocation->second);
+        trimTexturePool(gTexturePoolCapacity);
+    }
+
+    void setTexturePoolCapacity(unsigned int textureCount)
+    {
+        gTexturePoolCapacity = textureCount;
+        if (ImGui_ImplOpenGL3_GetBackendData())
+            trimTexturePool(gTexturePoolCapacity);
+    }
+
+    TexturePoolStats getTexturePoolStats()
+    {
+        TexturePoolStats stats;
+        stats.hits        = gTexturePoolHits;
+        stats.misses      = gTexturePoolMisses;
+        stats.pooledCount = (unsigned int)gTexturePool.size();
+        stats.capacity    = gTexturePoolCapacity;
+        return stats;
+    }
+
+    void clearTexturePool()
+    {
+        trimTexturePool(0);
+    }
+
+    // make sure texture has storage for a image of this geometry, storage is reused when nothing changed
+    static bool prepareImageTexture(TextureSource &texture, ImGuiImageFormat imageFormat, unsigned int imageWidth,
+                                    unsigned int imageHeight)
+    {
+        unsigned int planeCount = getPlaneCount(imageFormat);
+        if (planeCount <= 0)
+        {
+            dbg("unsupported format %d\n", imageFormat);
+            return false;
+        }
+
+        // Same geometry as last upload: keep the storage and only stream the pixels
+        bool reuseStorage = texture.imageFormat == imageFormat && texture.width == (int)imageWidth
+                            && texture.height == (int)imageHeight;
+        for (unsigned int i = 0; i < planeCount && reuseStorage; i++)
+        {
+            if (texture.textureID[i] == 0)
+                reuseStorage = false;
+        }
+
+        if (reuseStorage)
+            return true;
+
+        // old planes go back to the pool while texture still describes their geometry
+        for (unsigned int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
+            releasePlaneTexture(texture, i);
+
+        GLint last_texture;
+        GL_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture));
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(imageFormat, imageWidth, imageHeight, i, &bytesPerPixel, &width, &height);
+            GLint  internalFormat = GL_RGBA8;
+            GLenum format         = GL_RGBA;
+            GLenum type           = GL_UNSIGNED_BYTE;
+            if (!getPlaneGLFormat(imageFormat, bytesPerPixel, &internalFormat, &format, &type))
+            {
+                dbg("unsupported format %d\n", imageFormat);
+                GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
+                return false;
+            }
+
+            GLuint tex = acquirePooledTexture(width, height, internalFormat);
+            if (tex != 0)
+            {
+                texture.textureID[i] = (uintptr_t)tex;
+                continue;
+            }
+            GL_CALL(glGenTextures(1, &tex));
+            if (0 == tex)
+            {
+                GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
+                return false;
+            }
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, tex));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+            // allocate once, every following frame with the same geometry goes through glTexSubImage2D
+            GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr));
+            gPlaneAllocations[tex] = {tex, (GLsizei)width, (GLsizei)height, internalFormat};
+            texture.textureID[i]   = (uintptr_t)tex;
+        }
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
+
+        texture.width       = imageWidth;
+        texture.height      = imageHeight;
+        texture.imageFormat = imageFormat;
+
+        return true;
+    }
+
     bool updateImageTexture(ImageData &image, TextureSource &texture)
     {
         if (!glad_glGetError)
@@ -870,8 +1513,6 @@ namespace ImGui
             }                                                                 \
         } while (0)
 
-        GLint        last_texture;
-        GLuint       tex        = 0;
         unsigned int planeCount = getPlaneCount(image.format);
         if (planeCount <= 0)
         {
@@ -879,76 +1520,218 @@ namespace ImGui
             return false;
         }
 
-        for (unsigned int i = 0; i < planeCount; i++)
+        if (texture.streaming)
         {
-            if (texture.textureID[i] != 0)
+            // copy into the next pixel buffer of the ring, the texture is then updated from that buffer asynchronously
+            ImageData mapped = image;
+            if (!mapImageTexture(texture, mapped))
+                return false;
+            for (unsigned int i = 0; i < planeCount; i++)
             {
-                GLuint texID = (GLuint)texture.textureID[i];
-                GL_CALL(glDeleteTextures(1, &texID));
-                texture.textureID[i] = 0;
+                unsigned int bytesPerPixel = 0;
+                unsigned int width         = 0;
+                unsigned int height        = 0;
+                getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
+                unsigned int lineSize = width * bytesPerPixel;
+                if (image.stride[i] == mapped.stride[i])
+                {
+                    memcpy(mapped.plane[i], image.plane[i], (size_t)mapped.stride[i] * (height - 1) + lineSize);
+                    continue;
+                }
+                for (unsigned int y = 0; y < height; y++)
+                {
+                    memcpy(mapped.plane[i] + y * mapped.stride[i], image.plane[i] + y * image.stride[i], lineSize);
+                }
             }
+            return unmapImageTexture(texture);
+        }
+
+        if (!prepareImageTexture(texture, image.format, image.width, image.height))
+            return false;
+
+        GLint last_texture, last_alignment, last_row_length;
+        GL_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture));
+        GL_CALL(glGetIntegerv(GL_UNPACK_ALIGNMENT, &last_alignment));
+        GL_CALL(glGetIntegerv(GL_UNPACK_ROW_LENGTH, &last_row_length));
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
             unsigned int bytesPerPixel = 0;
             unsigned int width         = 0;
             unsigned int height        = 0;
             getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
-            GLint format = GL_RGBA;
-            switch (bytesPerPixel)
-            {
-                case 4:
-                    format = GL_RGBA;
-                    break;
-                case 2:
-                    format = GL_RG;
-                    break;
-                case 1:
-                    format = GL_RED;
-                    break;
-                default:
-                    dbg("unsupported format %d\n", image.format);
-                    return false;
-            }
-
-            do
-            {
-                glad_glGenTextures(1, &tex);
-                GLenum gl_err = glad_glGetError();
-                if (gl_err != 0)
-                    fprintf((__acrt_iob_func(2)), "GL error 0x%x returned from '%s'.\n", gl_err, "glGenTextures(1, &tex)");
-            } while (0);
-            if (0 == tex)
-                return false;
-            GL_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture));
-            GL_CALL(glBindTexture(GL_TEXTURE_2D, tex));
-            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-            GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-            texture.textureID[i] = (uintptr_t)tex;
+            GLint  internalFormat = GL_RGBA8;
+            GLenum format         = GL_RGBA;
+            GLenum type           = GL_UNSIGNED_BYTE;
+            getPlaneGLFormat(image.format, bytesPerPixel, &internalFormat, &format, &type);
 
-            unsigned int stride = width * bytesPerPixel;
-            if (image.stride[i] == stride)
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)texture.textureID[i]));
+            if (image.stride[i] % bytesPerPixel == 0)
             {
-                GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, image.plane[i]));
+                // GL walks the source rows by itself, padded strides and ROIs of a larger buffer are uploaded without copy
+                GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, image.stride[i] / bytesPerPixel));
+                GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, getUnpackAlignment(image.plane[i], image.stride[i])));
+                GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, type, image.plane[i]));
             }
             else
             {
-                auto tmpBuffer = std::make_unique<uint8_t[]>(stride * height);
+                // stride not a whole number of pixels, can't be described by GL_UNPACK_ROW_LENGTH
+                unsigned int stride    = width * bytesPerPixel;
+                auto         tmpBuffer = std::make_unique<uint8_t[]>(stride * height);
                 for (unsigned int y = 0; y < height; y++)
                 {
                     memcpy(tmpBuffer.get() + y * stride, image.plane[i] + y * image.stride[i], stride);
                 }
-                GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, tmpBuffer.get()));
+                GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+                GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+                GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, type, tmpBuffer.get()));
             }
+            if (texture.mipmaps)
+                GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
             ERROR_CHECK(DO_NOTING);
-            GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
         }
-        texture.width       = image.width;
-        texture.height      = image.height;
-        texture.imageFormat = image.format;
-        texture.colorRange  = image.colorRange;
+        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, last_row_length));
+        GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, last_alignment));
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
+
+        texture.colorRange = image.colorRange;
+        texture.colorSpace = image.colorSpace;
 
         return true;
     }
+
+    bool mapImageTexture(TextureSource &texture, ImageData &image)
+    {
+        if (!glad_glGetError)
+            return false;
+        if (texture.streamMapped)
+        {
+            dbg("texture is already mapped\n");
+            return false;
+        }
+
+        unsigned int planeCount = getPlaneCount(image.format);
+        if (planeCount <= 0)
+        {
+            dbg("unsupported format %d\n", image.format);
+            return false;
+        }
+        if (!prepareImageTexture(texture, image.format, image.width, image.height))
+            return false;
+
+        GLint last_pixel_buffer;
+        GL_CALL(glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &last_pixel_buffer));
+
+        // the buffer used last frame may still be read by the GPU, move on to the next one in the ring
+        unsigned int index  = (texture.streamIndex + 1) % IMGUI_IMAGE_STREAM_BUFFERS;
+        bool         mapped = true;
+        unsigned int i      = 0;
+        for (; i < planeCount; i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
+            // rows aligned to 4 bytes, matches the default GL_UNPACK_ALIGNMENT
+            unsigned int stride = (width * bytesPerPixel + 3) & ~3u;
+            size_t       size   = (size_t)stride * height;
+
+            GLuint pbo = (GLuint)texture.streamBuffer[i][index];
+            if (pbo == 0)
+            {
+                GL_CALL(glGenBuffers(1, &pbo));
+                texture.streamBuffer[i][index] = pbo;
+            }
+            GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo));
+            if (texture.streamBufferSize[i][index] != size)
+            {
+                GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_DRAW));
+                texture.streamBufferSize[i][index] = size;
+            }
+
+            void *ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (!ptr)
+            {
+                dbg("map pixel buffer fail 0x%x\n", glGetError());
+                mapped = false;
+                break;
+            }
+            image.plane[i]  = (uint8_t *)ptr;
+            image.stride[i] = stride;
+        }
+
+        if (!mapped)
+        {
+            for (unsigned int j = 0; j < i; j++)
+            {
+                GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, (GLuint)texture.streamBuffer[j][index]));
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                image.plane[j] = nullptr;
+            }
+        }
+        GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, last_pixel_buffer));
+        if (!mapped)
+            return false;
+
+        texture.streamIndex  = index;
+        texture.streamMapped = true;
+        texture.colorRange   = image.colorRange;
+        texture.colorSpace   = image.colorSpace;
+
+        return true;
+    }
+
+    bool unmapImageTexture(TextureSource &texture)
+    {
+        if (!glad_glGetError || !texture.streamMapped)
+            return false;
+        texture.streamMapped = false;
+
+        GLint last_pixel_buffer, last_texture, last_alignment, last_row_length;
+        GL_CALL(glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &last_pixel_buffer));
+        GL_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture));
+        GL_CALL(glGetIntegerv(GL_UNPACK_ALIGNMENT, &last_alignment));
+        GL_CALL(glGetIntegerv(GL_UNPACK_ROW_LENGTH, &last_row_length));
+        GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+        bool         ret        = true;
+        unsigned int index      = texture.streamIndex;
+        unsigned int planeCount = getPlaneCount(texture.imageFormat);
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(texture.imageFormat, texture.width, texture.height, i, &bytesPerPixel, &width, &height);
+            GLint  internalFormat = GL_RGBA8;
+            GLenum format         = GL_RGBA;
+            GLenum type           = GL_UNSIGNED_BYTE;
+            getPlaneGLFormat(texture.imageFormat, bytesPerPixel, &internalFormat, &format, &type);
+
+            GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, (GLuint)texture.streamBuffer[i][index]));
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+            {
+                // data store got corrupted while mapped, keep the previous content of this plane
+                dbg("pixel buffer of plane %u lost\n", i);
+                ret = false;
+                continue;
+            }
+            // source is the bound pixel buffer, the copy is queued and the call returns immediately
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)texture.textureID[i]));
+            GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, type, nullptr));
+            if (texture.mipmaps)
+                GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
+        }
+
+        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, last_row_length));
+        GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, last_alignment));
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture));
+        GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, last_pixel_buffer));
+
+        return ret;
+    }
+
     void freeTexture(TextureSource &texture)
     {
         ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
@@ -957,15 +1740,267 @@ namespace ImGui
 
         for (unsigned int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
         {
-            GLuint texID = (GLuint)texture.textureID[i];
-            if (texID > 0)
+            releasePlaneTexture(texture, i);
+            for (unsigned int j = 0; j < IMGUI_IMAGE_STREAM_BUFFERS; j++)
             {
-                GL_CALL(glDeleteTextures(1, &texID));
-                texture.textureID[i] = 0;
+                GLuint pbo = (GLuint)texture.streamBuffer[i][j];
+                if (pbo > 0)
+                {
+                    GL_CALL(glDeleteBuffers(1, &pbo));
+                    texture.streamBuffer[i][j]     = 0;
+                    texture.streamBufferSize[i][j] = 0;
+                }
             }
         }
+        texture.streamMapped = false;
         ERROR_CHECK(DO_NOTING);
     }
+
+    struct FrameCaptureRequest
+    {
+        FrameCaptureCallback callback;
+        ImVec2               regionPos;
+        ImVec2               regionSize;
+    };
+
+    // readback in flight, free when it has no callback
+    struct FrameCaptureBuffer
+    {
+        GLuint               pbo    = 0;
+        GLsync               fence  = nullptr;
+        size_t               size   = 0;
+        unsigned int         width  = 0;
+        unsigned int         height = 0;
+        FrameCaptureCallback callback;
+    };
+
+    struct FrameCaptureJob
+    {
+        FrameCaptureCallback callback;
+        ImageData            image;
+    };
+
+    static StdMutex                         gCaptureLock; // requests, jobs and the worker state
+    static std::vector<FrameCaptureRequest> gCaptureRequests;
+    static FrameCaptureBuffer               gCaptureBuffers[IMGUI_CAPTURE_BUFFERS];
+    static std::deque<FrameCaptureJob>      gCaptureJobs;
+    static std::condition_variable          gCaptureCond;
+    static std::thread                      gCaptureThread;
+    static bool                             gCaptureThreadExit = false;
+
+    bool captureFrame(const FrameCaptureCallback &callback, ImVec2 regionPos, ImVec2 regionSize)
+    {
+        if (!callback)
+            return false;
+        ImGui_ImplOpenGL3_Data *bd = ImGui_ImplOpenGL3_GetBackendData();
+        if (bd == nullptr || (bd->GlVersion < 320 && !bd->GlProfileIsES3))
+        {
+            dbg("frame capture needs fence sync objects\n");
+            return false;
+        }
+
+        StdMutexGuard lock(gCaptureLock);
+        gCaptureRequests.push_back({callback, regionPos, regionSize});
+        return true;
+    }
+
+    // encoding and saving of the captures happen here, off the render thread
+    static void captureWorker()
+    {
+        while (true)
+        {
+            FrameCaptureJob job;
+            {
+                StdMutexUniqueLock lock(gCaptureLock);
+                gCaptureCond.wait(lock, []() { return gCaptureThreadExit || !gCaptureJobs.empty(); });
+                // the queued jobs are done before exit
+                if (gCaptureJobs.empty())
+                    return;
+                job = std::move(gCaptureJobs.front());
+                gCaptureJobs.pop_front();
+            }
+            job.callback(job.image);
+        }
+    }
+
+    static void queueCaptureJob(FrameCaptureCallback &&callback, ImageData &&image)
+    {
+        {
+            StdMutexGuard lock(gCaptureLock);
+            gCaptureJobs.push_back({std::move(callback), std::move(image)});
+            if (!gCaptureThread.joinable())
+                gCaptureThread = std::thread(captureWorker);
+        }
+        gCaptureCond.notify_one();
+    }
+
+    static void readFrameCaptures(ImDrawData *drawData, int fbWidth, int fbHeight)
+    {
+        std::vector<FrameCaptureRequest> requests;
+        {
+            StdMutexGuard lock(gCaptureLock);
+            if (gCaptureRequests.empty())
+                return;
+            requests.swap(gCaptureRequests);
+        }
+
+        GLint last_pack_buffer, last_pack_alignment;
+        GL_CALL(glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &last_pack_buffer));
+        GL_CALL(glGetIntegerv(GL_PACK_ALIGNMENT, &last_pack_alignment));
+        GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+
+        size_t served = 0;
+        for (; served < requests.size(); served++)
+        {
+            FrameCaptureBuffer *buffer = nullptr;
+            for (auto &candidate : gCaptureBuffers)
+            {
+                if (!candidate.callback)
+                {
+                    buffer = &candidate;
+                    break;
+                }
+            }
+            if (!buffer)
+                break;
+
+            // viewport coordinates to framebuffer pixels, y goes up in GL
+            FrameCaptureRequest &request = requests[served];
+            int                  x0 = 0, y0 = 0, x1 = fbWidth, y1 = fbHeight;
+            if (request.regionSize.x > 0 && request.regionSize.y > 0)
+            {
+                ImVec2 scale = drawData->FramebufferScale;
+                float  minX  = (request.regionPos.x - drawData->DisplayPos.x) * scale.x;
+                float  minY  = (request.regionPos.y - drawData->DisplayPos.y) * scale.y;
+                x0           = ImClamp((int)floorf(minX), 0, fbWidth);
+                y0           = ImClamp((int)floorf(minY), 0, fbHeight);
+                x1           = ImClamp((int)ceilf(minX + request.regionSize.x * scale.x), 0, fbWidth);
+                y1           = ImClamp((int)ceilf(minY + request.regionSize.y * scale.y), 0, fbHeight);
+            }
+            if (x1 <= x0 || y1 <= y0)
+            {
+                dbg("capture region out of the framebuffer\n");
+                queueCaptureJob(std::move(request.callback), ImageData());
+                continue;
+            }
+
+            buffer->width  = (unsigned int)(x1 - x0);
+            buffer->height = (unsigned int)(y1 - y0);
+            size_t size    = (size_t)buffer->width * buffer->height * 4;
+            if (buffer->pbo == 0)
+                GL_CALL(glGenBuffers(1, &buffer->pbo));
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer->pbo));
+            if (buffer->size != size)
+            {
+                GL_CALL(glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_READ));
+                buffer->size = size;
+            }
+            // destination is the bound pixel buffer, the copy is queued and the call returns immediately
+            GL_CALL(glReadPixels(x0, fbHeight - y1, (GLsizei)buffer->width, (GLsizei)buffer->height, GL_RGBA,
+                                 GL_UNSIGNED_BYTE, nullptr));
+            buffer->fence    = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            buffer->callback = std::move(request.callback);
+        }
+
+        GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, last_pack_alignment));
+        GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, last_pack_buffer));
+
+        // all buffers in flight, the rest is read from a later frame
+        if (served < requests.size())
+        {
+            StdMutexGuard lock(gCaptureLock);
+            gCaptureRequests.insert(gCaptureRequests.begin(), std::make_move_iterator(requests.begin() + served),
+                                    std::make_move_iterator(requests.end()));
+        }
+    }
+
+    static void pollFrameCaptures()
+    {
+        GLint last_pack_buffer = -1;
+        for (auto &buffer : gCaptureBuffers)
+        {
+            if (!buffer.fence)
+                continue;
+            // zero timeout, only tells if the copy is done
+            GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                continue;
+            glDeleteSync(buffer.fence);
+            buffer.fence = nullptr;
+            if (status == GL_WAIT_FAILED)
+            {
+                dbg("capture fence wait fail 0x%x\n", glGetError());
+                queueCaptureJob(std::move(buffer.callback), ImageData());
+                buffer.callback = nullptr;
+                continue;
+            }
+
+            if (last_pack_buffer < 0)
+                GL_CALL(glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &last_pack_buffer));
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo));
+            const uint8_t *mapped =
+                (const uint8_t *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)buffer.size, GL_MAP_READ_BIT);
+            if (!mapped)
+            {
+                dbg("map capture buffer fail 0x%x\n", glGetError());
+                queueCaptureJob(std::move(buffer.callback), ImageData());
+                buffer.callback = nullptr;
+                continue;
+            }
+
+            // rows come bottom up from GL
+            unsigned int             stride = buffer.width * 4;
+            std::shared_ptr<uint8_t> pixels(new uint8_t[buffer.size], std::default_delete<uint8_t[]>());
+            for (unsigned int y = 0; y < buffer.height; y++)
+                memcpy(pixels.get() + (size_t)y * stride, mapped + (size_t)(buffer.height - 1 - y) * stride, stride);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+            ImageData image  = {};
+            image.plane[0]   = pixels.get();
+            image.stride[0]  = stride;
+            image.width      = buffer.width;
+            image.height     = buffer.height;
+            image.format     = ImGuiImageFormat_RGBA;
+            image.colorRange = ImGuiImageColorRange_0_255;
+            image.holder     = pixels;
+            queueCaptureJob(std::move(buffer.callback), std::move(image));
+            buffer.callback = nullptr;
+        }
+        if (last_pack_buffer >= 0)
+            GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, last_pack_buffer));
+    }
+
+    // every callback still waiting is called with an empty image, the worker runs them before it exits
+    static void freeFrameCaptures()
+    {
+        for (auto &buffer : gCaptureBuffers)
+        {
+            if (buffer.fence)
+                glDeleteSync(buffer.fence);
+            if (buffer.pbo)
+                GL_CALL(glDeleteBuffers(1, &buffer.pbo));
+            if (buffer.callback)
+                queueCaptureJob(std::move(buffer.callback), ImageData());
+            buffer = FrameCaptureBuffer();
+        }
+
+        std::vector<FrameCaptureRequest> requests;
+        {
+            StdMutexGuard lock(gCaptureLock);
+            requests.swap(gCaptureRequests);
+        }
+        for (auto &request : requests)
+            queueCaptureJob(std::move(request.callback), ImageData());
+
+        {
+            StdMutexGuard lock(gCaptureLock);
+            gCaptureThreadExit = true;
+        }
+        gCaptureCond.notify_all();
+        if (gCaptureThread.joinable())
+            gCaptureThread.join();
+        gCaptureThreadExit = false;
+    }
 } // namespace ImGui
 //-----------------------------------------------------------------------------
 
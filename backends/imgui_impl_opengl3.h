@@ -45,6 +45,31 @@ IMGUI_IMPL_API void ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// (Optional) Texture, sampler and uniform calls of the render loop, the ones skipped were already set
+struct ImGui_ImplOpenGL3_StateStats
+{
+    unsigned int IssuedCalls  = 0;
+    unsigned int SkippedCalls = 0;
+};
+// counts of the previous frame, all viewports included
+IMGUI_IMPL_API ImGui_ImplOpenGL3_StateStats ImGui_ImplOpenGL3_GetStateStats();
+
+// (Optional) GPU time per draw list, measured with GL_TIME_ELAPSED queries around each of them (GL 3.3+)
+// Results are read a few frames later, only when available, so the render loop never waits for the GPU.
+// Only the main viewport is measured, query objects are not shared with the contexts of the other viewports.
+struct ImGui_ImplOpenGL3_GpuTiming
+{
+    const ImDrawList *DrawList;      // compare with the draw lists of the windows to find the owner, may be gone already
+    float             TotalMs;       // image commands included
+    float             ImageMs;       // image commands only, when they are timed
+    int               ImageCommands;
+};
+IMGUI_IMPL_API void ImGui_ImplOpenGL3_SetGpuTimersEnabled(bool enabled, bool time_image_commands = false);
+IMGUI_IMPL_API bool ImGui_ImplOpenGL3_GpuTimersEnabled();
+IMGUI_IMPL_API bool ImGui_ImplOpenGL3_GpuTimersSupported();
+// draw lists of the latest frame with all results available, most expensive first. return the count
+IMGUI_IMPL_API int  ImGui_ImplOpenGL3_GetGpuTimings(const ImGui_ImplOpenGL3_GpuTiming **out_timings);
+
     // Configuration flags to add in your imconfig file:
     // #define IMGUI_IMPL_OPENGL_ES2     // Enable ES 2 (Auto-detected on Emscripten)
     // #define IMGUI_IMPL_OPENGL_ES3     // Enable ES 3 (Auto-detected on iOS/Android)
@@ -114,6 +114,7 @@
     #include <tchar.h>
     #include <dwmapi.h>
     #include <stdio.h>
+    #include <atomic>
 
     #include <Shlobj.h>
     #include <shlwapi.h>
@@ -188,11 +189,14 @@ static void ImGui_ImplWin32_UpdateKeyboardCodePage()
         bd->KeyboardCodePage = CP_ACP; // Fallback to default ANSI code page when fails.
 }
 
+static std::atomic<DWORD> gMainThreadId(0); // thread running the main loop, woken up by wakeMainLoop()
+
 static bool ImGui_ImplWin32_InitEx(void *hwnd, bool platform_has_own_dc)
 {
     ImGuiIO &io = ImGui::GetIO();
     IMGUI_CHECKVERSION();
     IM_ASSERT(io.BackendPlatformUserData == nullptr && "Already initialized a platform backend!");
+    gMainThreadId = ::GetCurrentThreadId();
 
     HRESULT hr = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
     if (FAILED(hr))
@@ -272,6 +276,7 @@ void ImGui_ImplWin32_Shutdown()
     IM_ASSERT(bd != nullptr && "No platform backend to shutdown, or already shutdown?");
     ImGuiIO &io = ImGui::GetIO();
 
+    gMainThreadId = 0;
     ImGui_ImplWin32_ShutdownMultiViewportSupport();
 
     // Unload XInput library
@@ -1766,6 +1771,14 @@ namespace ImGui
             return;
         ::SetWindowTextA(vd->Hwnd, utf8ToLocal(title).c_str());
     }
+
+    void wakeMainLoop()
+    {
+        // a thread message is enough to return from MsgWaitForMultipleObjects()
+        DWORD threadId = gMainThreadId;
+        if (threadId)
+            ::PostThreadMessage(threadId, WM_NULL, 0, 0);
+    }
 } // namespace ImGui
 //---------------------------------------------------------------------------------------------------------
 
@@ -9,15 +9,25 @@
 // - Introduction, links and more at the top of imgui.cpp
 
 #include "imgui.h"
+#include "imgui_internal.h" // InputEventsQueue, tells an input from a timeout in power saving mode
 #include "imgui_common_tools.h"
+#include "imgui_frame_pacer.h"
+#include "imgui_frame_profiler.h"
+#include "imgui_image_render.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "ImGuiApplication.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
 #define GL_SILENCE_DEPRECATION
 #if defined(IMGUI_IMPL_OPENGL_ES2)
     #include <GLES2/gl2.h>
+#else
+    #include "glad/glad.h" // framebuffer objects for the headless mode, loaded by ImGui_ImplOpenGL3_Init()
 #endif
 
 #if defined(_WIN32)
@@ -64,6 +74,70 @@ void dropFileCallback(GLFWwindow *window, int count, const char **files)
 
 const char *glsl_version = nullptr;
 
+// --headless [--frames N] [--verbose]: no visible window, frames are rendered into an offscreen framebuffer and timed,
+// a summary is printed at exit and with --verbose a line per frame too.
+// with GLFW 3.4 the context is surfaceless EGL (or OSMesa), so no display server is needed
+struct HeadlessRun
+{
+    bool                enabled     = false;
+    bool                verbose     = false;
+    int                 frameLimit  = 0; // 0 until the application exits
+    GLuint              framebuffer = 0;
+    GLuint              colorBuffer = 0;
+    int                 width       = 0;
+    int                 height      = 0;
+    std::vector<double> frameTimes; // ms, including the GPU work
+};
+static HeadlessRun gHeadless;
+
+#if !defined(IMGUI_IMPL_OPENGL_ES2)
+static void bindHeadlessFramebuffer(int width, int height)
+{
+    if (!gHeadless.framebuffer)
+    {
+        glGenFramebuffers(1, &gHeadless.framebuffer);
+        glGenRenderbuffers(1, &gHeadless.colorBuffer);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, gHeadless.framebuffer);
+    if (width == gHeadless.width && height == gHeadless.height)
+        return;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, gHeadless.colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, gHeadless.colorBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        fprintf(stderr, "headless framebuffer %dx%d incomplete\n", width, height);
+    gHeadless.width  = width;
+    gHeadless.height = height;
+}
+
+static void freeHeadlessFramebuffer()
+{
+    if (gHeadless.framebuffer)
+    {
+        glDeleteFramebuffers(1, &gHeadless.framebuffer);
+        glDeleteRenderbuffers(1, &gHeadless.colorBuffer);
+        gHeadless.framebuffer = 0;
+        gHeadless.colorBuffer = 0;
+    }
+}
+#endif
+
+static void reportHeadlessTimes()
+{
+    std::vector<double> &times = gHeadless.frameTimes;
+    if (times.empty())
+        return;
+
+    double total = 0;
+    for (double ms : times)
+        total += ms;
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    printf("headless: %zu frames, avg %.3f ms, min %.3f ms, median %.3f ms, p95 %.3f ms, max %.3f ms\n", times.size(),
+           total / times.size(), sorted.front(), sorted[sorted.size() / 2], sorted[sorted.size() * 95 / 100], sorted.back());
+}
+
 bool doGUIRender(GLFWwindow *window)
 {
     static ImVec4   clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
@@ -92,34 +166,63 @@ bool doGUIRender(GLFWwindow *window)
             glfwSwapInterval(0);
     }
 
+    FramePacer &pacer = getFramePacer();
     if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0)
     {
-        ImGui_ImplGlfw_Sleep(10);
+        // nothing is rendered, the cap only throttles event polling
+        int minimizedFps = gUserApp->getFrameRateLimit(false, true);
+        if (minimizedFps > 0)
+        {
+            pacer.setTargetFps(minimizedFps);
+            pacer.wait();
+        }
+        else
+        {
+            ImGui_ImplGlfw_Sleep(10);
+        }
         return false;
     }
 
+    FrameProfiler &profiler = getFrameProfiler();
+    profiler.beginFrame();
+
     // Start the Dear ImGui frame
+    profiler.beginPhase(FramePhase_NewFrame);
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
+    profiler.endPhase(FramePhase_NewFrame);
 
+    profiler.beginPhase(FramePhase_PreAction);
+    updateTextureStreams();
     gUserApp->newFramePreAction();
+    profiler.endPhase(FramePhase_PreAction);
 
     ImGui::NewFrame();
 
+    profiler.beginPhase(FramePhase_Show);
     gUserApp->show();
+    profiler.endPhase(FramePhase_Show);
     if (gUserApp->justClosed())
         return true;
 
     // Rendering
+    profiler.beginPhase(FramePhase_Render);
     ImGui::Render();
     gUserApp->endFramePostAction();
+    profiler.endPhase(FramePhase_Render);
 
+    profiler.beginPhase(FramePhase_RenderDrawData);
     int display_w, display_h;
     glfwGetFramebufferSize(window, &display_w, &display_h);
+#if !defined(IMGUI_IMPL_OPENGL_ES2)
+    if (gHeadless.enabled)
+        bindHeadlessFramebuffer(display_w, display_h);
+#endif
     glViewport(0, 0, display_w, display_h);
     glClearColor(clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w);
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    profiler.endPhase(FramePhase_RenderDrawData);
 
     // Update and Render additional Platform Windows
     // (Platform functions may change the current OpenGL context, so we save/restore it to make it easier to paste
@@ -127,13 +230,28 @@ bool doGUIRender(GLFWwindow *window)
     //  For this specific demo app we could also call glfwMakeContextCurrent(window) directly)
     if (io->ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
     {
-        GLFWwindow *backup_current_context = glfwGetCurrentContext();
+        FramePhaseScope phase(FramePhase_PlatformWindows);
+        GLFWwindow     *backup_current_context = glfwGetCurrentContext();
         ImGui::UpdatePlatformWindows();
         ImGui::RenderPlatformWindowsDefault();
         glfwMakeContextCurrent(backup_current_context);
     }
 
-    glfwSwapBuffers(window);
+    profiler.beginPhase(FramePhase_Swap);
+    if (gHeadless.enabled)
+        glFinish(); // nothing is presented, wait for the GPU so the frame time covers the rendering
+    else
+        glfwSwapBuffers(window);
+    profiler.endPhase(FramePhase_Swap);
+
+    // headless runs measure the unthrottled frame time
+    if (!gHeadless.enabled)
+    {
+        FramePhaseScope phase(FramePhase_Pace);
+        pacer.setTargetFps(gUserApp->getFrameRateLimit(!io->AppFocusLost, false));
+        pacer.wait();
+    }
+    profiler.endFrame();
     return false;
 }
 
@@ -159,7 +277,42 @@ int main(int argc, char **argv)
     int  argc;
     auto argv = CommandLineToArgvA(&argc);
 #endif
+    std::vector<std::string> cmdArgs;
+    for (int i = 0; i < argc; i++)
+    {
+#if defined(_WIN32)
+        std::string arg = argv[i].get();
+#else
+        std::string arg = argv[i];
+#endif
+        // headless options are consumed here, the application never sees them
+        if (arg == "--headless")
+        {
+            gHeadless.enabled = true;
+            continue;
+        }
+        if (arg == "--frames" && i + 1 < argc)
+        {
+#if defined(_WIN32)
+            gHeadless.frameLimit = atoi(argv[++i].get());
+#else
+            gHeadless.frameLimit = atoi(argv[++i]);
+#endif
+            continue;
+        }
+        if (arg == "--verbose")
+        {
+            gHeadless.verbose = true;
+            continue;
+        }
+        cmdArgs.push_back(arg);
+    }
+
     glfwSetErrorCallback(glfw_error_callback);
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    if (gHeadless.enabled)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
     if (!glfwInit())
         return 1;
 
@@ -196,8 +349,19 @@ int main(int argc, char **argv)
     startFontPixPreload();
 
     // Create window with graphics context
+    if (gHeadless.enabled)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
     GLFWwindow *window = glfwCreateWindow(gUserApp->getWindowInitialRect().w, gUserApp->getWindowInitialRect().h,
                                           gUserApp->getAppName().c_str(), nullptr, nullptr);
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    if (window == nullptr && gHeadless.enabled)
+    {
+        // no surfaceless EGL, try the software OSMesa context
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        window = glfwCreateWindow(gUserApp->getWindowInitialRect().w, gUserApp->getWindowInitialRect().h,
+                                  gUserApp->getAppName().c_str(), nullptr, nullptr);
+    }
+#endif
     if (window == nullptr)
         return 1;
 
@@ -236,7 +400,8 @@ int main(int argc, char **argv)
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable Keyboard Controls
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;  // Enable Gamepad Controls
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;     // Enable Docking
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;   // Enable Multi-Viewport / Platform Windows
+    if (!gHeadless.enabled)
+        io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable; // Enable Multi-Viewport / Platform Windows
     // io.ConfigViewportsNoAutoMerge = true;
     io.ConfigViewportsNoTaskBarIcon = false;
 
@@ -249,22 +414,14 @@ int main(int argc, char **argv)
         style.Colors[ImGuiCol_WindowBg].w = 1.0f;
     }
 
-    {
-        std::vector<std::string> tmpArgs;
-        for (int i = 0; i < argc; i++)
-        {
-#if defined(_WIN32)
-            tmpArgs.push_back(argv[i].get());
-#else
-
-            tmpArgs.push_back(argv[i]);
-#endif
-        }
-        gUserApp->transferCmdArgs(tmpArgs);
-    }
+    gUserApp->transferCmdArgs(cmdArgs);
 
     ImGui_ImplGlfw_InitForOpenGL(window, true);
 
+    // frames still to be rendered before waiting again in power saving mode, imgui needs a few frames to settle
+    // hover/animation state after an input
+    int settleFrames = 2;
+
     // Main loop
     while (!glfwWindowShouldClose(window))
     {
@@ -276,16 +433,48 @@ int main(int argc, char **argv)
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or
         // clear/overwrite your copy of the keyboard data. Generally you may always pass all inputs to dear imgui, and
         // hide them from your application based on those two flags.
-        glfwPollEvents();
+        if (takeRedrawRequest())
+            settleFrames = 2;
+        if (gHeadless.enabled || !gUserApp->PowerSavingEnabled() || settleFrames > 0)
+        {
+            glfwPollEvents();
+            if (settleFrames > 0)
+                settleFrames--;
+        }
+        else
+        {
+            // the timeout keeps polled content (animations, shared frames) refreshed at the idle rate with a single
+            // frame, only an input needs the settle frames
+            glfwWaitEventsTimeout(gUserApp->getIdleRefreshInterval());
+            if (ImGui::GetCurrentContext()->InputEventsQueue.Size > 0)
+                settleFrames = 2;
+        }
 
         if (g_exit)
             break;
 
-        if (doGUIRender(window))
+        if (!gHeadless.enabled)
+        {
+            if (doGUIRender(window))
+                break;
+            continue;
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+        bool closed     = doGUIRender(window);
+        gHeadless.frameTimes.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        if (gHeadless.verbose)
+            printf("headless: frame %zu %.3f ms\n", gHeadless.frameTimes.size(), gHeadless.frameTimes.back());
+        if (closed || (gHeadless.frameLimit > 0 && (int)gHeadless.frameTimes.size() >= gHeadless.frameLimit))
             break;
     }
 
     gUserApp->exit();
+    reportHeadlessTimes();
+#if !defined(IMGUI_IMPL_OPENGL_ES2)
+    freeHeadlessFramebuffer();
+#endif
 
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
@@ -10,6 +10,9 @@
 #include <tchar.h>
 
 #include "imgui_common_tools.h"
+#include "imgui_frame_pacer.h"
+#include "imgui_frame_profiler.h"
+#include "imgui_image_render.h"
 #include "imgui_impl_dx11.h"
 #include "imgui_impl_win32.h"
 #include "ImGuiApplication.h"
@@ -41,9 +44,20 @@ bool doGUIRender()
         io = &ImGui::GetIO();
 
     // Handle window being minimized or screen locked
+    FramePacer &pacer = getFramePacer();
     if (g_SwapChainOccluded && g_pSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)
     {
-        ::Sleep(10);
+        // nothing is rendered, the cap only throttles message polling
+        int minimizedFps = gUserApp->getFrameRateLimit(false, true);
+        if (minimizedFps > 0)
+        {
+            pacer.setTargetFps(minimizedFps);
+            pacer.wait();
+        }
+        else
+        {
+            ::Sleep(10);
+        }
         return false;
     }
     g_SwapChainOccluded = false;
@@ -57,42 +71,66 @@ bool doGUIRender()
         CreateRenderTarget();
     }
 
+    FrameProfiler &profiler = getFrameProfiler();
+    profiler.beginFrame();
+
     // Start the Dear ImGui frame
+    profiler.beginPhase(FramePhase_NewFrame);
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplWin32_NewFrame();
+    profiler.endPhase(FramePhase_NewFrame);
 
+    profiler.beginPhase(FramePhase_PreAction);
+    updateTextureStreams();
     gUserApp->newFramePreAction();
+    profiler.endPhase(FramePhase_PreAction);
 
     ImGui::NewFrame();
 
+    profiler.beginPhase(FramePhase_Show);
     gUserApp->show();
+    profiler.endPhase(FramePhase_Show);
     if (gUserApp->justClosed())
         return true;
 
     // Rendering
+    profiler.beginPhase(FramePhase_Render);
     ImGui::Render();
     gUserApp->endFramePostAction();
+    profiler.endPhase(FramePhase_Render);
 
+    profiler.beginPhase(FramePhase_RenderDrawData);
     const float clear_color_with_alpha[4] = {clear_color.x * clear_color.w, clear_color.y * clear_color.w,
                                              clear_color.z * clear_color.w, clear_color.w};
     g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
     g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    profiler.endPhase(FramePhase_RenderDrawData);
 
     // Update and Render additional Platform Windows
     if (io->ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
     {
+        FramePhaseScope phase(FramePhase_PlatformWindows);
         ImGui::UpdatePlatformWindows();
         ImGui::RenderPlatformWindowsDefault();
     }
 
     // Present
+    profiler.beginPhase(FramePhase_Swap);
     HRESULT hr = S_OK;
     if (gUserApp->VSyncEnabled())
         hr = g_pSwapChain->Present(1, 0); // Present with vsync
     else
         hr = g_pSwapChain->Present(0, 0); // Present without vsync
     g_SwapChainOccluded = (hr == DXGI_STATUS_OCCLUDED);
+    profiler.endPhase(FramePhase_Swap);
+
+    {
+        FramePhaseScope phase(FramePhase_Pace);
+        pacer.setTargetFps(gUserApp->getFrameRateLimit(!io->AppFocusLost, false));
+        pacer.wait();
+    }
+    profiler.endFrame();
 
     return false;
 }
@@ -207,11 +245,28 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     // Main loop
     g_resources_initialized = true;
     bool done               = false;
+    int  settleFrames       = 2; // frames still to be rendered before waiting again in power saving mode
     while (!done)
     {
         if (g_exit)
             break;
 
+        if (takeRedrawRequest())
+            settleFrames = 2;
+        if (settleFrames > 0)
+        {
+            settleFrames--;
+        }
+        else if (gUserApp->PowerSavingEnabled())
+        {
+            // returns on any input or wakeMainLoop(), the timeout keeps polled content refreshed at the idle rate with a
+            // single frame
+            DWORD wait = ::MsgWaitForMultipleObjects(0, nullptr, FALSE, (DWORD)(gUserApp->getIdleRefreshInterval() * 1000),
+                                                     QS_ALLINPUT);
+            if (wait != WAIT_TIMEOUT)
+                settleFrames = 2;
+        }
+
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
         MSG msg;
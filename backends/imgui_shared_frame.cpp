@@ -0,0 +1,259 @@
+#include <new>
+#include <string.h>
+
+#include "imgui_shared_frame.h"
+
+namespace ImGui
+{
+    static constexpr size_t SHARED_FRAME_ALIGN = 64;
+
+    static size_t alignSize(size_t size)
+    {
+        return (size + SHARED_FRAME_ALIGN - 1) & ~(SHARED_FRAME_ALIGN - 1);
+    }
+
+    // plane layout of a frame inside a slot, return total bytes or 0 if format not supported
+    static size_t getSlotLayout(const ImageData &image, uint32_t stride[IMGUI_IMAGE_MAX_PLANES],
+                                uint64_t offset[IMGUI_IMAGE_MAX_PLANES])
+    {
+        unsigned int planeCount = getPlaneCount(image.format);
+        if (planeCount <= 0)
+            return 0;
+
+        size_t total = 0;
+        for (unsigned int i = 0; i < planeCount; i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
+            stride[i] = (uint32_t)alignSize(width * bytesPerPixel);
+            offset[i] = total;
+            total += alignSize((size_t)stride[i] * height);
+        }
+        return total;
+    }
+
+    SharedFrameProducer::~SharedFrameProducer()
+    {
+        close();
+    }
+
+    bool SharedFrameProducer::create(const std::string &name, unsigned int slotCount, size_t slotSize)
+    {
+        close();
+        if (slotCount < 2 || slotCount > IMGUI_SHARED_FRAME_MAX_SLOTS)
+        {
+            dbg("slot count %u out of range [2, %d]\n", slotCount, IMGUI_SHARED_FRAME_MAX_SLOTS);
+            return false;
+        }
+
+        size_t dataOffset = alignSize(sizeof(SharedFrameHeader));
+        slotSize          = alignSize(slotSize);
+        if (!openSharedMemory(name, dataOffset + slotSize * slotCount, true, mMemory))
+        {
+            dbg("%s\n", getLastError().c_str());
+            return false;
+        }
+
+        mHeader = new (mMemory.data) SharedFrameHeader();
+        for (unsigned int i = 0; i < IMGUI_SHARED_FRAME_MAX_SLOTS; i++)
+            mHeader->slots[i].sequence.store(0, std::memory_order_relaxed);
+        mHeader->slotCount  = slotCount;
+        mHeader->dataOffset = (uint32_t)dataOffset;
+        mHeader->slotSize   = slotSize;
+        mHeader->version    = IMGUI_SHARED_FRAME_VERSION;
+        mHeader->frameCount.store(0, std::memory_order_relaxed);
+        // readers check the magic last
+        std::atomic_thread_fence(std::memory_order_release);
+        mHeader->magic = IMGUI_SHARED_FRAME_MAGIC;
+
+        return true;
+    }
+
+    void SharedFrameProducer::close()
+    {
+        if (mWriting)
+            endFrame();
+        mHeader = nullptr;
+        closeSharedMemory(mMemory);
+    }
+
+    bool SharedFrameProducer::beginFrame(ImageData &image)
+    {
+        if (!mHeader || mWriting)
+            return false;
+
+        uint32_t stride[IMGUI_IMAGE_MAX_PLANES] = {0};
+        uint64_t offset[IMGUI_IMAGE_MAX_PLANES] = {0};
+        size_t   frameSize                      = getSlotLayout(image, stride, offset);
+        if (frameSize == 0 || frameSize > mHeader->slotSize)
+        {
+            dbg("frame %ux%u format %d does not fit in slot\n", image.width, image.height, image.format);
+            return false;
+        }
+
+        uint64_t         frame = mHeader->frameCount.load(std::memory_order_relaxed);
+        SharedFrameSlot &slot  = mHeader->slots[frame % mHeader->slotCount];
+        slot.sequence.store(frame * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.format     = image.format;
+        slot.colorRange = image.colorRange;
+        slot.width      = image.width;
+        slot.height     = image.height;
+
+        uint8_t *data = (uint8_t *)mMemory.data + mHeader->dataOffset + (frame % mHeader->slotCount) * mHeader->slotSize;
+        for (unsigned int i = 0; i < IMGUI_IMAGE_MAX_PLANES; i++)
+        {
+            slot.stride[i]  = stride[i];
+            slot.offset[i]  = offset[i];
+            image.plane[i]  = stride[i] > 0 ? data + offset[i] : nullptr;
+            image.stride[i] = stride[i];
+        }
+        mWriting = true;
+
+        return true;
+    }
+
+    void SharedFrameProducer::endFrame()
+    {
+        if (!mHeader || !mWriting)
+            return;
+        mWriting = false;
+
+        uint64_t         frame = mHeader->frameCount.load(std::memory_order_relaxed);
+        SharedFrameSlot &slot  = mHeader->slots[frame % mHeader->slotCount];
+        slot.sequence.store((frame + 1) * 2, std::memory_order_release);
+        mHeader->frameCount.store(frame + 1, std::memory_order_release);
+    }
+
+    bool SharedFrameProducer::sendFrame(const ImageData &image)
+    {
+        ImageData slotImage = image;
+        if (!beginFrame(slotImage))
+            return false;
+
+        for (unsigned int i = 0; i < getPlaneCount(image.format); i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
+            for (unsigned int y = 0; y < height; y++)
+                memcpy(slotImage.plane[i] + (size_t)y * slotImage.stride[i], image.plane[i] + (size_t)y * image.stride[i],
+                       width * bytesPerPixel);
+        }
+        endFrame();
+
+        return true;
+    }
+
+    SharedFrameSource::~SharedFrameSource()
+    {
+        close();
+    }
+
+    bool SharedFrameSource::open(const std::string &name)
+    {
+        close();
+        if (!openSharedMemory(name, 0, false, mMemory))
+        {
+            dbg("%s\n", getLastError().c_str());
+            return false;
+        }
+
+        // the producer lives in another process, don't trust anything in the header
+        SharedFrameHeader *header = (SharedFrameHeader *)mMemory.data;
+        if (mMemory.size < sizeof(SharedFrameHeader) || header->magic != IMGUI_SHARED_FRAME_MAGIC)
+        {
+            dbg("%s is not a shared frame ring\n", name.c_str());
+            closeSharedMemory(mMemory);
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // no products or sums of the header fields that could wrap around
+        if (header->version != IMGUI_SHARED_FRAME_VERSION || header->slotCount < 2
+            || header->slotCount > IMGUI_SHARED_FRAME_MAX_SLOTS || header->dataOffset > mMemory.size
+            || header->slotSize > (mMemory.size - header->dataOffset) / header->slotCount)
+        {
+            dbg("%s has an invalid header\n", name.c_str());
+            closeSharedMemory(mMemory);
+            return false;
+        }
+
+        mHeader     = header;
+        mLastFrame  = 0;
+        mTornFrames = 0;
+
+        return true;
+    }
+
+    void SharedFrameSource::close()
+    {
+        mHeader = nullptr;
+        closeSharedMemory(mMemory);
+        freeTexture(mStaging);
+    }
+
+    bool SharedFrameSource::update(TextureSource &texture)
+    {
+        if (!mHeader)
+            return false;
+
+        uint64_t frameCount = mHeader->frameCount.load(std::memory_order_acquire);
+        if (frameCount == 0 || frameCount == mLastFrame)
+            return false;
+
+        unsigned int     slotIndex = (unsigned int)((frameCount - 1) % mHeader->slotCount);
+        SharedFrameSlot &slot      = mHeader->slots[slotIndex];
+        uint64_t         sequence  = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != frameCount * 2)
+        {
+            // already being rewritten, pick the newer one next frame
+            mTornFrames++;
+            return false;
+        }
+
+        ImageData image  = {};
+        image.format     = (ImGuiImageFormat)slot.format;
+        image.colorRange = (ImGuiImageColorRange)slot.colorRange;
+        image.width      = slot.width;
+        image.height     = slot.height;
+        if (INVALID_IMAGE_FORMAT(image.format) || INVALID_COLOR_RANGE(image.colorRange))
+            return false;
+
+        uint8_t *data = (uint8_t *)mMemory.data + mHeader->dataOffset + slotIndex * mHeader->slotSize;
+        for (unsigned int i = 0; i < getPlaneCount(image.format); i++)
+        {
+            unsigned int bytesPerPixel = 0;
+            unsigned int width         = 0;
+            unsigned int height        = 0;
+            getPlaneInfo(image.format, image.width, image.height, i, &bytesPerPixel, &width, &height);
+            if (slot.stride[i] < width * bytesPerPixel || slot.offset[i] > mHeader->slotSize
+                || (uint64_t)slot.stride[i] * height > mHeader->slotSize - slot.offset[i])
+                return false;
+            image.plane[i]  = data + slot.offset[i];
+            image.stride[i] = slot.stride[i];
+        }
+
+        // texture upload reads straight from the shared slot, into the staging texture until the frame is known whole
+        mStaging.mipmaps   = texture.mipmaps;
+        mStaging.streaming = texture.streaming;
+        bool ret           = updateImageTexture(image, mStaging);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            // overwritten during the upload, the newer frame replaces it next time
+            mTornFrames++;
+            return false;
+        }
+        mLastFrame = frameCount;
+
+        if (ret)
+            swapTextureSource(texture, mStaging);
+        return ret;
+    }
+
+} // namespace ImGui
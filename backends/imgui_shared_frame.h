@@ -0,0 +1,99 @@
+#ifndef IMGUI_SHARED_FRAME_H_
+#define IMGUI_SHARED_FRAME_H_
+
+#include <atomic>
+#include <string>
+
+#include "imgui_common_tools.h"
+#include "imgui_image_render.h"
+
+#define IMGUI_SHARED_FRAME_MAGIC     0x46534749 // "IGSF"
+#define IMGUI_SHARED_FRAME_VERSION   1
+#define IMGUI_SHARED_FRAME_MAX_SLOTS 8
+
+namespace ImGui
+{
+    // Frame ring living in shared memory, written by one producer process and read by any number of viewers.
+    // Every slot is guarded by a sequence number (seqlock): odd while the producer writes it, 2 * (frame index + 1) once
+    // complete. Readers never block the producer, a frame overwritten while being read is detected and skipped.
+    struct SharedFrameSlot
+    {
+        std::atomic<uint64_t> sequence;
+        int32_t               format;
+        int32_t               colorRange;
+        uint32_t              width;
+        uint32_t              height;
+        uint32_t              stride[IMGUI_IMAGE_MAX_PLANES];
+        uint64_t              offset[IMGUI_IMAGE_MAX_PLANES]; // from the start of the slot data
+    };
+
+    struct SharedFrameHeader
+    {
+        uint32_t              magic;
+        uint32_t              version;
+        uint32_t              slotCount;
+        uint32_t              dataOffset; // slot data starts here, slot i at dataOffset + i * slotSize
+        uint64_t              slotSize;
+        std::atomic<uint64_t> frameCount; // published frames, the newest one is in slot (frameCount - 1) % slotCount
+        SharedFrameSlot       slots[IMGUI_SHARED_FRAME_MAX_SLOTS];
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared frame header needs lock free 64 bit atomics");
+
+    class SharedFrameProducer
+    {
+    public:
+        SharedFrameProducer() = default;
+        ~SharedFrameProducer();
+        SharedFrameProducer(const SharedFrameProducer &)            = delete;
+        SharedFrameProducer &operator=(const SharedFrameProducer &) = delete;
+
+        // slotSize is the largest frame (all planes) that can be published
+        bool create(const std::string &name, unsigned int slotCount, size_t slotSize);
+        void close();
+        bool isOpened() { return mHeader != nullptr; }
+
+        // image.format/width/height/colorRange describe the frame, plane/stride point into the next slot on success.
+        // write the pixels then publish them with endFrame()
+        bool beginFrame(ImageData &image);
+        void endFrame();
+
+        // copy image into the next slot and publish it
+        bool sendFrame(const ImageData &image);
+
+    private:
+        SharedMemory       mMemory;
+        SharedFrameHeader *mHeader  = nullptr;
+        bool               mWriting = false;
+    };
+
+    class SharedFrameSource
+    {
+    public:
+        SharedFrameSource() = default;
+        ~SharedFrameSource();
+        SharedFrameSource(const SharedFrameSource &)            = delete;
+        SharedFrameSource &operator=(const SharedFrameSource &) = delete;
+
+        bool open(const std::string &name);
+        void close();
+        bool isOpened() { return mHeader != nullptr; }
+
+        // render thread, upload the newest frame straight from shared memory when a new one was published.
+        // it goes to a staging texture first, which is swapped with texture only if the frame wasn't torn meanwhile.
+        // return true if texture got a new frame
+        bool update(TextureSource &texture);
+
+        uint64_t lastFrame() { return mLastFrame; }
+        uint64_t tornFrames() { return mTornFrames; }
+
+    private:
+        SharedMemory       mMemory;
+        SharedFrameHeader *mHeader     = nullptr;
+        uint64_t           mLastFrame  = 0;
+        uint64_t           mTornFrames = 0;
+        TextureSource      mStaging; // the texture shown before the last swap, reused for the next upload
+    };
+
+} // namespace ImGui
+
+#endif
@@ -534,6 +534,52 @@ namespace ImGui
         return unicodeToUtf8(cur_dir);
     }
 
+    bool openSharedMemory(const string &name, size_t size, bool create, SharedMemory &shm)
+    {
+        wstring mapName = utf8ToUnicode(name);
+        HANDLE  mapping = nullptr;
+        if (create)
+            mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+                                         (DWORD)(size & 0xFFFFFFFF), mapName.c_str());
+        else
+            mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, mapName.c_str());
+        if (!mapping)
+        {
+            gLastError = combineString("map ", name, " fail: ", HResultToStr(HRESULT_FROM_WIN32(GetLastError())));
+            return false;
+        }
+
+        void *data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, create ? size : 0);
+        if (!data)
+        {
+            gLastError = combineString("MapViewOfFile ", name, " fail: ", HResultToStr(HRESULT_FROM_WIN32(GetLastError())));
+            CloseHandle(mapping);
+            return false;
+        }
+        if (!create)
+        {
+            MEMORY_BASIC_INFORMATION info;
+            VirtualQuery(data, &info, sizeof(info));
+            size = info.RegionSize;
+        }
+
+        shm.name   = name;
+        shm.data   = data;
+        shm.size   = size;
+        shm.handle = (uintptr_t)mapping;
+        shm.owner  = create;
+        return true;
+    }
+
+    void closeSharedMemory(SharedMemory &shm)
+    {
+        if (shm.data)
+            UnmapViewOfFile(shm.data);
+        if (shm.handle)
+            CloseHandle((HANDLE)shm.handle);
+        shm = SharedMemory();
+    }
+
     std::string getSystemPictureFolder()
     {
         string result;
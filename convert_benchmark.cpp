@@ -0,0 +1,158 @@
+// Benchmark of the CPU colour conversions: convertImageToRGBA() for every format and convertRGBAToI420(),
+// once per kernel set the cpu supports (C, SSE2, AVX2), reported in MPix/s
+// usage: convertBenchmark [width] [height] [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "imgui_image_render.h"
+
+using namespace ImGui;
+
+struct BenchFormat
+{
+    ImGuiImageFormat format;
+    const char      *name;
+};
+
+static const BenchFormat gFormats[] = {
+    {ImGuiImageFormat_RGBA,        "RGBA"       },
+    {ImGuiImageFormat_BGRA,        "BGRA"       },
+    {ImGuiImageFormat_Gray,        "Gray"       },
+    {ImGuiImageFormat_YUV444P,     "YUV444P"    },
+    {ImGuiImageFormat_YUV422P,     "YUV422P"    },
+    {ImGuiImageFormat_YUV411P,     "YUV411P"    },
+    {ImGuiImageFormat_YUV420P,     "YUV420P"    },
+    {ImGuiImageFormat_YV12,        "YV12"       },
+    {ImGuiImageFormat_NV12,        "NV12"       },
+    {ImGuiImageFormat_NV21,        "NV21"       },
+    {ImGuiImageFormat_P010,        "P010"       },
+    {ImGuiImageFormat_P016,        "P016"       },
+    {ImGuiImageFormat_YUV420P10LE, "YUV420P10LE"},
+    {ImGuiImageFormat_Gray16,      "Gray16"     },
+    {ImGuiImageFormat_RGBA16,      "RGBA16"     },
+    {ImGuiImageFormat_R32F,        "R32F"       },
+};
+
+static const char *gKernelNames[ImGuiImageConvertKernel_Max] = {"C", "SSE2", "AVX2"};
+
+// planes of format filled with a pattern, the memory is kept by image.holder
+static bool makeImage(ImGuiImageFormat format, unsigned int width, unsigned int height, ImageData &image)
+{
+    image            = {};
+    image.format     = format;
+    image.width      = width;
+    image.height     = height;
+    image.colorRange = ImGuiImageColorRange_16_235;
+
+    unsigned int planeCount                        = getPlaneCount(format);
+    size_t       planeSize[IMGUI_IMAGE_MAX_PLANES] = {0};
+    size_t       totalSize                         = 0;
+    for (unsigned int i = 0; i < planeCount; i++)
+    {
+        unsigned int bytesPerPixel = 0;
+        unsigned int planeWidth    = 0;
+        unsigned int planeHeight   = 0;
+        if (getPlaneInfo(format, width, height, i, &bytesPerPixel, &planeWidth, &planeHeight) < 0)
+            return false;
+        image.stride[i] = planeWidth * bytesPerPixel;
+        planeSize[i]    = (size_t)image.stride[i] * planeHeight;
+        totalSize += planeSize[i];
+    }
+
+    auto buffer  = std::make_shared<std::vector<uint8_t>>(totalSize);
+    image.holder = buffer;
+    for (size_t i = 0; i < totalSize; i++)
+        (*buffer)[i] = (uint8_t)(i * 7 + (i >> 11));
+    if (format == ImGuiImageFormat_R32F)
+    {
+        // keep the floats finite
+        float *values = (float *)buffer->data();
+        for (size_t i = 0; i < totalSize / 4; i++)
+            values[i] = (float)(i % 1024) / 1023.f;
+    }
+
+    uint8_t *plane = buffer->data();
+    for (unsigned int i = 0; i < planeCount; i++)
+    {
+        image.plane[i] = plane;
+        plane += planeSize[i];
+    }
+    return true;
+}
+
+template <typename Func>
+static double measureMPixPerSecond(unsigned int width, unsigned int height, int iterations, Func &&func)
+{
+    func(); // warm up, page in the buffers
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        func();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double)width * height * iterations / seconds / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int width      = argc > 1 ? (unsigned int)atoi(argv[1]) : 1920;
+    unsigned int height     = argc > 2 ? (unsigned int)atoi(argv[2]) : 1080;
+    int          iterations = argc > 3 ? atoi(argv[3]) : 50;
+    if (width < 4 || height < 4 || iterations <= 0)
+    {
+        fprintf(stderr, "invalid arguments %ux%u x%d\n", width, height, iterations);
+        return 1;
+    }
+    width &= ~3u;
+    height &= ~1u;
+
+    std::vector<ImGuiImageConvertKernel> kernels;
+    for (int kernel = 0; kernel < ImGuiImageConvertKernel_Max; kernel++)
+    {
+        if (setImageConvertKernel((ImGuiImageConvertKernel)kernel))
+            kernels.push_back((ImGuiImageConvertKernel)kernel);
+    }
+
+    printf("%ux%u, %d iterations, MPix/s (frames of 1MPix and more are split into row bands across threads)\n", width,
+           height, iterations);
+    printf("%-16s", "");
+    for (auto kernel : kernels)
+        printf("%10s", gKernelNames[kernel]);
+    printf("\n");
+
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+    for (const auto &format : gFormats)
+    {
+        ImageData image;
+        if (!makeImage(format.format, width, height, image))
+            continue;
+
+        printf("%-16s", format.name);
+        for (auto kernel : kernels)
+        {
+            setImageConvertKernel(kernel);
+            double speed = measureMPixPerSecond(width, height, iterations,
+                                                [&]() { convertImageToRGBA(image, rgba.data()); });
+            printf("%10.1f", speed);
+        }
+        printf("\n");
+    }
+
+    ImageData i420;
+    if (makeImage(ImGuiImageFormat_YUV420P, width, height, i420))
+    {
+        printf("%-16s", "RGBA -> I420");
+        for (auto kernel : kernels)
+        {
+            setImageConvertKernel(kernel);
+            double speed = measureMPixPerSecond(width, height, iterations,
+                                                [&]() { convertRGBAToI420(rgba.data(), width * 4, i420); });
+            printf("%10.1f", speed);
+        }
+        printf("\n");
+    }
+
+    setImageConvertKernel(ImGuiImageConvertKernel_AVX2);
+    return 0;
+}
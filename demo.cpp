@@ -22,11 +22,14 @@ public:
     void exitInternal() override { printf(">>>>>>>>exit\n"); }
 
 private:
+    // frames published by sharedFrameProducer
+    SharedFrameSource mFrameSource;
+    ImageWindow       mFrameWindow;
 };
 
 Application imguiApp;
 
-Application::Application()
+Application::Application() : mFrameWindow("Shared Frame")
 {
 #if defined(DEBUG) || defined(_DEBUG)
     openDebugWindow();
@@ -49,13 +52,23 @@ bool Application::renderUI()
 
     ImGui::ShowDemoWindow();
 
+    if (mFrameSource.isOpened())
+        mFrameWindow.show();
+
     return false;
 }
 
 void Application::transferCmdArgs(std::vector<std::string> &args)
 {
-    IM_UNUSED(args);
     // Process Command Line Arguments
+    for (size_t i = 1; i + 1 < args.size(); i++)
+    {
+        if (args[i] == "--shared-frame" && mFrameSource.open(args[i + 1]))
+        {
+            mFrameWindow.setFrameSource(&mFrameSource);
+            mFrameWindow.open();
+        }
+    }
 }
 
 void Application::dropFile(const std::vector<std::string> &files)
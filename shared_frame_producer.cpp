@@ -0,0 +1,67 @@
+// Test producer for SharedFrameSource: publishes a moving NV12 pattern into a shared frame ring
+// usage: sharedFrameProducer [name] [width] [height]
+// view it from another process with: imguiDemo --shared-frame [name]
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+#include "imgui_shared_frame.h"
+
+using namespace ImGui;
+
+static std::atomic<bool> gRunning = true;
+
+int main(int argc, char **argv)
+{
+    std::string  name   = argc > 1 ? argv[1] : "imgui_shared_frame_demo";
+    unsigned int width  = argc > 2 ? (unsigned int)atoi(argv[2]) : 1280;
+    unsigned int height = argc > 3 ? (unsigned int)atoi(argv[3]) : 720;
+    if (width < 2 || height < 2)
+    {
+        fprintf(stderr, "invalid size %ux%u\n", width, height);
+        return 1;
+    }
+    width &= ~1u;
+    height &= ~1u;
+
+    SharedFrameProducer producer;
+    if (!producer.create(name, 3, (size_t)width * height * 2))
+        return 1;
+    signal(SIGINT, [](int) { gRunning = false; });
+    printf("publishing %ux%u NV12 to %s, Ctrl+C to stop\n", width, height, name.c_str());
+
+    for (unsigned int frame = 0; gRunning; frame++)
+    {
+        ImageData image  = {};
+        image.format     = ImGuiImageFormat_NV12;
+        image.colorRange = ImGuiImageColorRange_16_235;
+        image.width      = width;
+        image.height     = height;
+        if (!producer.beginFrame(image))
+            return 1;
+
+        // luma ramp scrolling right, chroma slowly cycling
+        for (unsigned int y = 0; y < height; y++)
+        {
+            uint8_t *line = image.plane[0] + (size_t)y * image.stride[0];
+            for (unsigned int x = 0; x < width; x++)
+                line[x] = (uint8_t)(16 + (x + frame * 4) % 220);
+        }
+        for (unsigned int y = 0; y < height / 2; y++)
+        {
+            uint8_t *line = image.plane[1] + (size_t)y * image.stride[1];
+            for (unsigned int x = 0; x < width / 2; x++)
+            {
+                line[x * 2]     = (uint8_t)(16 + (y + frame) % 224);
+                line[x * 2 + 1] = (uint8_t)(16 + (x + frame * 2) % 224);
+            }
+        }
+        producer.endFrame();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(33));
+    }
+
+    return 0;
+}
@@ -1,4 +1,6 @@
 
+#include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <map>
 #include <string_view>
@@ -9,6 +11,15 @@
 #include "imgui_internal.h"
 #include "ImGuiTools.h"
 #include "ImGuiBaseTypes.h"
+#include "imgui_common_tools.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMGUI_TOOLS_X86
+    #include <emmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
 
 #ifdef IMGUI_ENABLE_FREETYPE
     #include "ImGuiApplication.h"
@@ -98,19 +109,6 @@ namespace ImGui
         {ColorWhite,       REVERSE_U32_COLOR(DFDFDFFF)}, //  #DFDFDFFF
     };
 
-    int getUtf8CharSize(const char *str)
-    {
-        int     charSize = 1;
-        uint8_t c        = *str;
-        if (c & 0x80)
-        {
-            charSize = 0;
-            while (c & (0x1 << (8 - charSize - 1)))
-                charSize++;
-        }
-        return charSize;
-    }
-
     DrawParam::DrawParam(DrawType type, const DrawLineParam &line) : type(type), param(line)
     {
         IM_ASSERT(type == DRAW_TYPE_LINE);
@@ -136,104 +134,214 @@ namespace ImGui
         IM_ASSERT(type == DRAW_TYPE_TEXT);
     }
 
-    void LoggerWindow::displayTexts()
+    void LoggerWindow::updateLineIndex(float wrapWidth)
     {
-        StdMutexGuard lock(mLogLock);
+        // widths depend on the font, start over when it changes
+        ImFont *font     = GetFont();
+        float   fontSize = GetFontSize();
+        if (font != mIndexFont || fontSize != mIndexFontSize)
+        {
+            mIndexFont      = font;
+            mIndexFontSize  = fontSize;
+            mIndexWrapWidth = wrapWidth;
+            mLines.clear();
+            mBreaks.clear();
+            mBreaksBase   = 0;
+            mIndexedTexts = mEvictedTexts;
+            mFirstRow     = 0;
+            mTotalRows    = 0;
+            mMaxLineWidth = 0;
+            mLogsChanged  = true;
+        }
+
+        // drop the evicted lines, the rows and breaks keep counting from the first line ever indexed
+        while (!mLines.empty() && mLines.front().firstText < mEvictedTexts)
+        {
+            size_t breaks = mLines.size() > 1 ? mLines[1].firstBreak - mBreaksBase : mBreaks.size();
+            mBreaks.erase(mBreaks.begin(), mBreaks.begin() + breaks);
+            mBreaksBase += breaks;
+            mLines.pop_front();
+        }
+        mIndexedTexts = MAX(mIndexedTexts, mEvictedTexts);
+        mFirstRow     = mLines.empty() ? mTotalRows : mLines.front().row;
+
+        if (wrapWidth != mIndexWrapWidth)
+        {
+            // the widths are kept, only lines wider than the window are laid out again
+            mIndexWrapWidth = wrapWidth;
+            mBreaks.clear();
+            mBreaksBase = 0;
+            mFirstRow   = 0;
+            mTotalRows  = 0;
+            for (auto &line : mLines)
+            {
+                line.row = mTotalRows;
+                layoutLine(line);
+                mTotalRows += line.rows;
+            }
+        }
+        if (!mLogsChanged)
+            return;
+
+        // text may have been appended to the last line, also to its last text before it was ended
+        if (!mLines.empty() && mLastLineOpen)
+        {
+            mTotalRows -= mLines.back().rows;
+            mIndexedTexts = mLines.back().firstText;
+            mBreaks.resize(mLines.back().firstBreak - mBreaksBase);
+            mLines.pop_back();
+        }
 
-        ImVec2 contentSize = GetContentRegionAvail();
+        size_t text     = mIndexedTexts;
+        size_t textsEnd = mEvictedTexts + mLogs.size();
+        while (text < textsEnd)
+        {
+            LogLine line   = {};
+            line.firstText = text;
+            line.row       = mTotalRows;
+            while (text < textsEnd)
+            {
+                const DisplayText &displayText = textAt(text++);
+                const char        *str         = textData(displayText);
+                line.width += measureText(str, str + displayText.length);
+                line.textCount++;
+                if (displayText.endLine)
+                    break;
+            }
+            layoutLine(line);
 
-        string showingStr;
+            mTotalRows += line.rows;
+            mMaxLineWidth = MAX(mMaxLineWidth, line.width);
+            mLines.push_back(line);
+        }
+        mIndexedTexts = text;
+        mLastLineOpen = !mLines.empty() && !textAt(text - 1).endLine;
+        mFirstRow     = mLines.empty() ? mTotalRows : mLines.front().row;
+        mLogsChanged  = false;
+    }
 
-        bool colorSet = false;
+    // one pass of glyph advances, the same sum CalcTextSize() makes without allocating
+    float LoggerWindow::measureText(const char *begin, const char *end)
+    {
+        float scale = mIndexFontSize / mIndexFont->FontSize;
+        float width = 0;
+        while (begin < end)
+        {
+            unsigned int c   = 0;
+            int          len = ImTextCharFromUtf8(&c, begin, end);
+            begin += len > 0 ? len : 1;
+            if (c != '\r')
+                width += mIndexFont->GetCharAdvance((ImWchar)c) * scale;
+        }
+        return width;
+    }
 
-        mTotalLines = 0;
+    // rows of line at mIndexWrapWidth, splitting at characters like the unwrapped text would overflow
+    void LoggerWindow::layoutLine(LogLine &line)
+    {
+        line.rows       = 1;
+        line.firstBreak = mBreaksBase + mBreaks.size();
+        if (mIndexWrapWidth <= 0 || line.width <= mIndexWrapWidth)
+            return;
 
-        TextColorCode curColor  = ColorNone;
-        bool          newLine   = true;
-        float         lineWidth = 0;
-        ImVec2        startPos  = GetCursorScreenPos();
-        ImVec2        endPos    = startPos;
-        for (auto &log : mLogs)
+        float scale = mIndexFontSize / mIndexFont->FontSize;
+        float x     = 0;
+        for (size_t i = 0; i < line.textCount; i++)
         {
-            if (log.color != curColor)
+            const DisplayText &text  = textAt(line.firstText + i);
+            const char        *begin = textData(text);
+            const char        *s     = begin;
+            const char        *end   = s + text.length;
+            while (s < end)
             {
-                if (colorSet)
+                unsigned int c       = 0;
+                int          len     = ImTextCharFromUtf8(&c, s, end);
+                float        advance = c == '\r' ? 0 : mIndexFont->GetCharAdvance((ImWchar)c) * scale;
+                if (x > 0 && x + advance > mIndexWrapWidth)
                 {
-                    PopStyleColor(1);
-                    colorSet = false;
+                    mBreaks.push_back({(uint32_t)i, (uint32_t)(s - begin)});
+                    line.rows++;
+                    x = 0;
                 }
-                if (log.color > ColorNone && log.color < ColorButt)
-                {
-                    PushStyleColor(ImGuiCol_Text, ColorValueMap[log.color]);
-                    colorSet = true;
-                }
-                curColor = log.color;
+                x += advance;
+                s += len > 0 ? len : 1;
             }
+        }
+    }
 
-            if (!newLine)
-            {
-                SameLine(0, 0);
-                mTotalLines -= GetTextLineHeightWithSpacing();
-            }
-            else
+    void LoggerWindow::drawLine(const LogLine &line)
+    {
+        size_t nextBreak = line.firstBreak - mBreaksBase;
+        size_t breakEnd  = nextBreak + line.rows - 1;
+        bool   sameRow   = false;
+        for (size_t i = 0; i < line.textCount; i++)
+        {
+            const DisplayText &text    = textAt(line.firstText + i);
+            bool               colored = text.color > ColorNone && text.color < ColorButt;
+            if (colored)
+                PushStyleColor(ImGuiCol_Text, ColorValueMap[text.color]);
+
+            const char *str   = textData(text);
+            size_t      start = 0;
+            while (true)
             {
-                if (lineWidth > mMaxLineWidth)
-                    mMaxLineWidth = lineWidth;
-                lineWidth = 0;
+                bool   rowEnds = nextBreak < breakEnd && mBreaks[nextBreak].text == i;
+                size_t stop    = rowEnds ? mBreaks[nextBreak].offset : text.length;
+                if (sameRow)
+                    SameLine(0, 0);
+                TextUnformatted(str + start, str + stop);
+                sameRow = true;
+                if (!rowEnds)
+                    break;
+                start   = stop;
+                sameRow = false;
+                nextBreak++;
             }
 
-            if (mWordWrap && GetCursorPosX() + CalcTextSize(log.text.c_str()).x > contentSize.x - GetStyle().ScrollbarSize)
-            {
-                string &showStr      = log.text;
-                size_t  displayStart = 0;
-                while (displayStart < showStr.length())
-                {
-                    size_t displayLength = 0;
-                    while (1)
-                    {
-                        if (displayStart + displayLength >= showStr.length())
-                            break;
+            if (colored)
+                PopStyleColor(1);
+        }
+    }
 
-                        // process utf-8 character
-                        int charSize = getUtf8CharSize(&showStr[displayStart + displayLength]);
+    void LoggerWindow::displayTexts()
+    {
+        StdMutexGuard lock(mLogLock);
 
-                        if (CalcTextSize(showStr.substr(displayStart, displayLength + charSize).c_str()).x
-                            > contentSize.x - GetStyle().ScrollbarSize)
-                            break;
+        float  wrapWidth = mWordWrap ? MAX(GetContentRegionAvail().x - GetStyle().ScrollbarSize, 1.f) : 0;
+        size_t firstRow  = mFirstRow;
+        updateLineIndex(wrapWidth);
 
-                        displayLength += charSize;
-                    }
-                    if (0 == displayLength) // can't display even one character
-                    {
-                        if (colorSet)
-                            PopStyleColor(1);
+        float lineHeight = GetTextLineHeightWithSpacing();
+        // keep the rows in view while the oldest ones are evicted above them
+        if (mScrollLocked && mFirstRow > firstRow)
+            SetScrollY(MAX(GetScrollY() - (mFirstRow - firstRow) * lineHeight, 0.f));
 
-                        return;
-                    }
-                    Text("%s", showStr.substr(displayStart, displayLength).c_str());
-                    mTotalLines += GetTextLineHeightWithSpacing();
-                    displayStart += displayLength;
-                }
-            }
-            else
+        size_t rowCount = mTotalRows - mFirstRow;
+        BeginChild("Log Text Content", ImVec2(mWordWrap ? 0 : mMaxLineWidth, rowCount * lineHeight), ImGuiChildFlags_None,
+                   ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar);
+
+        // only the rows in view are submitted, a wrapped line starting above the view is drawn from its first row
+        float            startY = GetCursorPosY();
+        ImGuiListClipper clipper;
+        clipper.Begin((int)rowCount, lineHeight);
+        while (clipper.Step())
+        {
+            auto lineIt = std::upper_bound(mLines.begin(), mLines.end(), mFirstRow + clipper.DisplayStart,
+                                           [](size_t row, const LogLine &line) { return row < line.row; });
+            if (lineIt != mLines.begin())
+                lineIt--;
+            for (; lineIt != mLines.end() && lineIt->row < mFirstRow + clipper.DisplayEnd; lineIt++)
             {
-                Text("%s", log.text.c_str());
-                lineWidth += CalcTextSize(log.text.c_str()).x;
-                mTotalLines += GetTextLineHeightWithSpacing();
+                SetCursorPosY(startY + (lineIt->row - mFirstRow) * lineHeight);
+                drawLine(*lineIt);
             }
-            if (log.endLine)
-                newLine = true;
-            else
-                newLine = false;
         }
-        if (lineWidth > mMaxLineWidth)
-            mMaxLineWidth = lineWidth;
+        clipper.End();
 
-        if (colorSet)
-            PopStyleColor(1);
+        if (IsWindowHovered())
+            SetMouseCursor(ImGuiMouseCursor_TextInput);
 
-        endPos      = GetCursorScreenPos();
-        mTotalLines = endPos.y - startPos.y;
+        EndChild();
     }
 
     bool positiveDirSelection(ImVec2 start, ImVec2 end)
@@ -241,8 +349,12 @@ namespace ImGui
         return end.y > start.y || (end.y == start.y && end.x > start.x);
     }
 
-    LoggerWindow::LoggerWindow(std::string title, bool embed) : IImGuiWindow(title)
+    LoggerWindow::LoggerWindow(std::string title, bool embed)
+        : IImGuiWindow(title), mChunks(new LogChunk[IMGUI_LOG_RING_CHUNKS])
     {
+        for (size_t i = 0; i < IMGUI_LOG_RING_CHUNKS; i++)
+            mChunks[i].sequence.store(i, std::memory_order_relaxed);
+
         if (embed)
         {
             mIsChildWindow = true;
@@ -254,6 +366,12 @@ namespace ImGui
 
     LoggerWindow::~LoggerWindow() {}
 
+    void LoggerWindow::show()
+    {
+        drainChunks();
+        IImGuiWindow::show();
+    }
+
     void LoggerWindow::setWordWrap(bool wordWrap)
     {
         if (mWordWrap != wordWrap)
@@ -284,20 +402,16 @@ namespace ImGui
             copyToClipBoard();
         }
 
+        SameLine();
+        Text("Lines: %zu (%.1f MB), Backlog: %.1f KB, Dropped: %llu (%.1f KB)", mLineCount,
+             mArenas.size() * (IMGUI_LOG_ARENA_SIZE / (1024.0 * 1024.0)), mQueuedBytes.load() / 1024.0,
+             (unsigned long long)mDroppedChunks.load(), mDroppedBytes.load() / 1024.0);
+
         BeginChild("Log Text", ImVec2(0, 0), ImGuiChildFlags_None,
                    ImGuiWindowFlags_NoMove | ImGuiWindowFlags_HorizontalScrollbar);
 
-        BeginChild("Log Text Content", ImVec2(mWordWrap ? 0 : mMaxLineWidth, mTotalLines), ImGuiChildFlags_None,
-                   ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar);
-
         displayTexts();
 
-        bool hovered = ImGui::IsWindowHovered();
-        if (hovered)
-            ImGui::SetMouseCursor(ImGuiMouseCursor_TextInput);
-
-        EndChild();
-
         if (IsKeyDown(ImGuiKey_MouseWheelY) && GetIO().MouseWheel > 0)
             mScrollLocked = true;
         else if (GetScrollY() == GetScrollMaxY())
@@ -317,110 +431,376 @@ namespace ImGui
         vsnprintf(buf, sizeof(buf), fmt, vl);
         va_end(vl);
 
-        string log(buf);
+        appendString(string(buf));
+    }
 
-        appendString(log);
+#define LOG_CONTROL_MAX 32 // longer unterminated escape sequences are dropped
+
+    // first '\n', '\r' or ESC in [begin, end)
+    static const char *findLogControl(const char *begin, const char *end)
+    {
+#ifdef IMGUI_TOOLS_X86
+        const __m128i newLine  = _mm_set1_epi8('\n');
+        const __m128i carriage = _mm_set1_epi8('\r');
+        const __m128i escape   = _mm_set1_epi8('\033');
+        for (; end - begin >= 16; begin += 16)
+        {
+            __m128i chars = _mm_loadu_si128((const __m128i *)begin);
+            __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, newLine), _mm_cmpeq_epi8(chars, carriage)),
+                                         _mm_cmpeq_epi8(chars, escape));
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(found);
+            if (mask)
+            {
+    #ifdef _MSC_VER
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return begin + index;
+    #else
+                return begin + __builtin_ctz(mask);
+    #endif
+            }
+        }
+#endif
+        while (begin < end && *begin != '\n' && *begin != '\r' && *begin != '\033')
+            begin++;
+        return begin;
+    }
+
+    // length of the control sequence at s, 0 if it continues past end
+    static size_t logControlLength(const char *s, const char *end)
+    {
+        if (*s == '\n')
+            return 1;
+        if (s + 1 == end)
+            return 0;
+        if (*s == '\r')
+            return s[1] == '\n' ? 2 : 1;
+        if (s[1] != '[') // not a CSI, only the ESC is dropped
+            return 1;
+        for (const char *p = s + 2; p < end; p++)
+        {
+            if (*p >= 0x40 && *p <= 0x7e) // final byte
+                return p - s + 1;
+        }
+        return 0;
+    }
+
+    DisplayText &LoggerWindow::currentText()
+    {
+        if (mLogs.empty() || mLogs.back().endLine)
+        {
+            mLogs.push_back({mWritePos});
+            mLineCount++;
+        }
+        return mLogs.back();
+    }
+
+    const char *LoggerWindow::textData(const DisplayText &text) const
+    {
+        if (text.length == 0) // an open text may still point to a released arena
+            return "";
+        const LogArena &arena = mArenas[(text.offset - mArenas.front().base) / IMGUI_LOG_ARENA_SIZE];
+        return arena.data.get() + (text.offset - arena.base);
     }
 
-    // return the position of the splitString
-    size_t splitString(const string &str, size_t start, const vector<string> &splitStrings, int &outSpiltIdx)
+    // appends to the open text while it is in the current arena, a text never spans two arenas
+    void LoggerWindow::appendText(const char *str, size_t length)
     {
-        outSpiltIdx        = -1;
-        size_t minSplitPos = str.length();
-        for (size_t idx = 0; idx < splitStrings.size(); idx++)
+        while (length > 0)
         {
-            size_t splitPos = str.find(splitStrings[idx], start);
-            if (splitPos < minSplitPos)
+            size_t room  = mArenas.empty() ? 0 : (size_t)(mArenas.back().base + IMGUI_LOG_ARENA_SIZE - mWritePos);
+            size_t count = length;
+            if (count > room)
             {
-                outSpiltIdx = (int)idx;
-                minSplitPos = splitPos;
+                // a run longer than an arena fills the rest of the current one, splitting between characters
+                count = length > IMGUI_LOG_ARENA_SIZE ? room : 0;
+                while (count > 0 && ((uint8_t)str[count] & 0xc0) == 0x80)
+                    count--;
+                if (count == 0)
+                {
+                    addArena();
+                    continue;
+                }
             }
+
+            DisplayText *text = &currentText();
+            if (text->length == 0)
+            {
+                text->offset = mWritePos;
+            }
+            else if (text->offset < mArenas.back().base) // continues in a new arena
+            {
+                mLogs.push_back({mWritePos, 0, text->color});
+                text = &mLogs.back();
+            }
+
+            const LogArena &arena = mArenas.back();
+            memcpy(arena.data.get() + (mWritePos - arena.base), str, count);
+            text->length += (uint32_t)count;
+            mWritePos += count;
+            str += count;
+            length -= count;
         }
+    }
 
-        return minSplitPos;
+    void LoggerWindow::addArena()
+    {
+        while (!mArenas.empty() && mArenas.size() >= mMaxArenas)
+            evictArena();
+
+        LogArena arena;
+        arena.base = mNextArenaBase;
+        arena.data = mSpareArena ? std::move(mSpareArena) : std::unique_ptr<char[]>(new char[IMGUI_LOG_ARENA_SIZE]);
+        mArenas.push_back(std::move(arena));
+        mNextArenaBase += IMGUI_LOG_ARENA_SIZE;
+        mWritePos = mArenas.back().base;
     }
 
-    static const vector<string> gSplitStrings = {
-        "\n",       "\r\n",       "\033[0m",    "\033[30m", "\033[0;30m", "\033[1;30m", "\033[34m", "\033[0;34m", "\033[1;34m",
-        "\033[32m", "\033[0;32m", "\033[1;32m", "\033[36m", "\033[0;36m", "\033[1;36m", "\033[31m", "\033[0;31m", "\033[1;31m",
-        "\033[35m", "\033[0;35m", "\033[1;35m", "\033[33m", "\033[0;33m", "\033[1;33m", "\033[37m", "\033[0;37m", "\033[1;37m",
-    };
+    // evicting the lines starting in the oldest arena releases it
+    void LoggerWindow::evictArena()
+    {
+        uint64_t arenaEnd = mArenas.front().base + IMGUI_LOG_ARENA_SIZE;
+        while (!mLogs.empty() && mLogs.front().offset < arenaEnd)
+            evictFrontLine();
+        releaseArenas();
+    }
 
-    string_view startWithStrings(string_view srcString, const vector<string> &cmpStrings)
+    // the whole line goes, including its texts in later arenas
+    void LoggerWindow::evictFrontLine()
     {
-        for (size_t i = 0; i < cmpStrings.size(); i++)
+        while (!mLogs.empty())
         {
-            if (srcString.substr(0, cmpStrings[i].length()) == cmpStrings[i])
+            bool endLine = mLogs.front().endLine;
+            mLogs.pop_front();
+            mEvictedTexts++;
+            if (endLine)
+                break;
+        }
+        mLineCount--;
+        mLogsChanged = true;
+    }
+
+    void LoggerWindow::trimLogs()
+    {
+        while (mLineCount > mMaxLines)
+            evictFrontLine();
+        releaseArenas();
+    }
+
+    // arenas before the first stored text, one buffer is kept for the next arena
+    void LoggerWindow::releaseArenas()
+    {
+        while (!mArenas.empty() && (mLogs.empty() || mLogs.front().offset >= mArenas.front().base + IMGUI_LOG_ARENA_SIZE))
+        {
+            if (!mSpareArena)
+                mSpareArena = std::move(mArenas.front().data);
+            mArenas.pop_front();
+        }
+    }
+
+    // runs between control characters are copied at once, a control sequence cut at end is kept in mPendingControl
+    void LoggerWindow::parseLogs(const char *begin, const char *end)
+    {
+        const char *s = begin;
+        while (s < end)
+        {
+            const char *control = findLogControl(s, end);
+            if (control > s)
+                appendText(s, control - s);
+            if (control == end)
+                break;
+
+            size_t length = logControlLength(control, end);
+            if (length == 0)
             {
-                return cmpStrings[i];
+                if (end - control < LOG_CONTROL_MAX)
+                {
+                    mPendingControl.assign(control, end);
+                    break;
+                }
+                length = 1;
+            }
+            s = control + length;
+
+            if (*control == '\n' || (length == 2 && *control == '\r'))
+            {
+                currentText().endLine = true;
+            }
+            else if (*control == '\r') // a lone '\r' is kept as text
+            {
+                appendText("\r", 1);
+            }
+            else if (control[length - 1] == 'm') // SGR, other CSI sequences are dropped
+            {
+                auto colorIt = gStrColorMap.find(string_view(control, length));
+                if (colorIt == gStrColorMap.end())
+                    continue;
+
+                DisplayText &curText = currentText();
+                if (curText.length == 0) // nothing in this color yet, just change it
+                    curText.color = colorIt->second;
+                else
+                    mLogs.push_back({mWritePos, 0, colorIt->second});
             }
         }
-        return "";
     }
 
     void LoggerWindow::appendString(const string &appendStr)
     {
-        if (appendStr.empty())
-            return;
+        if (!appendStr.empty())
+            pushChunk(string(appendStr));
+    }
 
-        StdMutexGuard lock(mLogLock);
+    void LoggerWindow::appendString(string &&appendStr)
+    {
+        if (!appendStr.empty())
+            pushChunk(std::move(appendStr));
+    }
 
-        if (mLogs.empty() || mLogs.back().endLine)
+    // bounded MPMC queue of D. Vyukov with a single consumer: a producer claims a position with a CAS and publishes
+    // the slot through its sequence, so producers never wait for each other or for the UI thread
+    void LoggerWindow::pushChunk(string &&text)
+    {
+        size_t size = text.size();
+        if (mQueuedBytes.fetch_add(size) + size > IMGUI_LOG_RING_MAX_BYTES)
+        {
+            mQueuedBytes -= size;
+            mDroppedChunks++;
+            mDroppedBytes += size;
+            return;
+        }
+
+        size_t pos = mChunkPushPos.load(std::memory_order_relaxed);
+        while (true)
         {
-            mLogs.push_back({});
+            LogChunk &chunk    = mChunks[pos & (IMGUI_LOG_RING_CHUNKS - 1)];
+            size_t    sequence = chunk.sequence.load(std::memory_order_acquire);
+            if (sequence == pos)
+            {
+                if (mChunkPushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    chunk.text = std::move(text);
+                    chunk.sequence.store(pos + 1, std::memory_order_release);
+                    break;
+                }
+            }
+            else if ((ptrdiff_t)(sequence - pos) < 0) // not drained since the last round, the ring is full
+            {
+                mQueuedBytes -= size;
+                mDroppedChunks++;
+                mDroppedBytes += size;
+                return;
+            }
+            else // claimed by another producer
+            {
+                pos = mChunkPushPos.load(std::memory_order_relaxed);
+            }
         }
-        DisplayText *curLine = &mLogs.back();
-        string_view  appendStrView(appendStr);
 
-#define NEW_LINE()               \
-    do                           \
-    {                            \
-        mLogs.push_back({});     \
-        curLine = &mLogs.back(); \
-    } while (0)
+        requestRedraw(); // logs may come from other threads while the main loop is idle
+    }
+
+    // UI thread only, false if the ring is empty
+    bool LoggerWindow::popChunk(string &text)
+    {
+        LogChunk &chunk = mChunks[mChunkPopPos & (IMGUI_LOG_RING_CHUNKS - 1)];
+        if (chunk.sequence.load(std::memory_order_acquire) != mChunkPopPos + 1)
+            return false;
+
+        text = std::move(chunk.text);
+        chunk.sequence.store(mChunkPopPos + IMGUI_LOG_RING_CHUNKS, std::memory_order_release);
+        mChunkPopPos++;
+        return true;
+    }
 
-        for (size_t i = 0; i < appendStrView.length(); i++)
+    void LoggerWindow::drainChunks()
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(IMGUI_LOG_DRAIN_BUDGET_MS);
+
+        StdMutexGuard lock(mLogLock);
+        while (true)
         {
-            string_view splitStr = startWithStrings(appendStrView.substr(i), gSplitStrings);
-            if (splitStr.empty())
+            if (mDrainOffset == mDrainText.size())
             {
-                curLine->text += appendStrView[i];
-                continue;
+                if (!popChunk(mDrainText))
+                    break;
+                mDrainOffset = 0;
             }
 
-            if (splitStr == "\n" || splitStr == "\r\n")
+            // a large append is parsed in slices, a control sequence cut at the end of one goes to mPendingControl.
+            // slices end between characters as the next one may start a new arena and so a new DisplayText
+            const char *slice     = mDrainText.data() + mDrainOffset;
+            size_t      remaining = mDrainText.size() - mDrainOffset;
+            size_t      length    = std::min(remaining, (size_t)IMGUI_LOG_DRAIN_SLICE);
+            size_t      cut       = length;
+            while (cut > 0 && cut < remaining && ((uint8_t)slice[cut] & 0xc0) == 0x80)
+                cut--;
+            if (cut > 0)
+                length = cut;
+            mDrainOffset += length;
+            mQueuedBytes -= length;
+
+            if (mPendingControl.empty())
             {
-                curLine->endLine = true;
-                if (i < appendStrView.length() - 1) // not the end, add a new line to logs
-                {
-                    NEW_LINE();
-                }
+                parseLogs(slice, slice + length);
             }
-            else if (gStrColorMap.find(splitStr) != gStrColorMap.end()) // color change
+            else
             {
-                TextColorCode color = gStrColorMap[splitStr];
-                if (curLine->text.empty()) // empty line, just change the color
-                {
-                    curLine->color = color;
-                }
-                else // add a new line
-                {
-                    NEW_LINE();
-                    curLine->color = color;
-                }
+                string joined = mPendingControl;
+                joined.append(slice, length);
+                mPendingControl.clear();
+                parseLogs(joined.data(), joined.data() + joined.size());
+            }
+            if (mDrainOffset == mDrainText.size())
+            {
+                mDrainText   = string();
+                mDrainOffset = 0;
+            }
+            trimLogs();
+            mLogsChanged = true;
+
+            if (std::chrono::steady_clock::now() >= deadline) // the rest is for the next frames
+            {
+                requestRedraw();
+                break;
             }
-            i += splitStr.length() - 1;
         }
-        mLogsChanged = true;
     }
 
     void LoggerWindow::clear()
     {
         StdMutexGuard lock(mLogLock);
         mMaxLineWidth = 0;
-        mTotalLines   = 0;
         mLogs.clear();
-        mLogsChanged = true;
+        mEvictedTexts = 0;
+        mLineCount    = 0;
+        releaseArenas();
+        mPendingControl.clear();
+        mLines.clear();
+        mBreaks.clear();
+        mBreaksBase   = 0;
+        mIndexedTexts = 0;
+        mFirstRow     = 0;
+        mTotalRows    = 0;
+        mLogsChanged  = true;
+
+        // the waiting appends are dropped too
+        mQueuedBytes -= mDrainText.size() - mDrainOffset;
+        mDrainText   = string();
+        mDrainOffset = 0;
+        string text;
+        while (popChunk(text))
+            mQueuedBytes -= text.size();
+    }
+
+    void LoggerWindow::setCapacity(size_t maxLines, size_t maxBytes)
+    {
+        StdMutexGuard lock(mLogLock);
+        mMaxLines  = maxLines;
+        mMaxArenas = MAX(maxBytes / IMGUI_LOG_ARENA_SIZE, (size_t)2);
+        while (mArenas.size() > mMaxArenas)
+            evictArena();
+        trimLogs();
     }
 
     void LoggerWindow::copyToClipBoard()
@@ -430,7 +810,7 @@ namespace ImGui
         string totalString;
         for (auto &log : mLogs)
         {
-            totalString += log.text;
+            totalString.append(textData(log), log.length);
             if (log.endLine)
                 totalString += '\n';
         }
@@ -461,8 +841,229 @@ namespace ImGui
         mImageShowPos.y     = mImageShowPos.y + (-(int)((mouseMove.y) * mTexture.height / imgScaleSize.y));
     }
 
+    ImageStatsWindow::ImageStatsWindow(std::string title) : IImGuiWindow(title)
+    {
+        memset(mHistograms, 0, sizeof(mHistograms));
+    }
+
+    bool ImageStatsWindow::setImage(const ImageData &image)
+    {
+        return mStats.setImage(image);
+    }
+
+    void ImageStatsWindow::clear()
+    {
+        mStats.clear();
+        mRequestValid = false;
+        mHasResult    = false;
+    }
+
+    bool ImageStatsWindow::hasImage()
+    {
+        return mStats.hasImage();
+    }
+
+    void ImageStatsWindow::setRegions(const std::vector<DrawRectParam> &rects, ImVec2 cursor)
+    {
+        mRects  = rects;
+        mCursor = cursor;
+    }
+
+    void ImageStatsWindow::updateHistograms()
+    {
+        for (int c = 0; c < mResult.channelCount; c++)
+        {
+            for (int bin = 0; bin < IMGUI_STATS_HISTOGRAM_BINS; bin++)
+            {
+                float count         = (float)mResult.channels[c].histogram[bin];
+                mHistograms[c][bin] = mLogScale ? log10f(count + 1) : count;
+            }
+        }
+    }
+
+    void ImageStatsWindow::showContent()
+    {
+        if (!mStats.hasImage())
+        {
+            TextUnformatted("No image data");
+            return;
+        }
+
+        if (mRegionIndex >= (int)mRects.size())
+            mRegionIndex = -1;
+        string preview = mRegionIndex < 0 ? "Whole Image" : "Rect " + std::to_string(mRegionIndex);
+        SetNextItemWidth(GetFontSize() * 10);
+        if (BeginCombo("Region", preview.c_str()))
+        {
+            if (Selectable("Whole Image", mRegionIndex < 0))
+                mRegionIndex = -1;
+            for (int i = 0; i < (int)mRects.size(); i++)
+            {
+                string label = "Rect " + std::to_string(i);
+                if (Selectable(label.c_str(), mRegionIndex == i))
+                    mRegionIndex = i;
+            }
+            EndCombo();
+        }
+        SameLine();
+        if (Checkbox("Log Scale", &mLogScale))
+            updateHistograms();
+
+        // region in image pixels, 0 size for the whole image
+        unsigned int region[4] = {};
+        if (mRegionIndex >= 0)
+        {
+            const DrawRectParam &rect = mRects[mRegionIndex];
+            float                x0   = MAX(MIN(rect.topLeft.x, rect.bottomRight.x), 0.f);
+            float                y0   = MAX(MIN(rect.topLeft.y, rect.bottomRight.y), 0.f);
+            float                x1   = MAX(MAX(rect.topLeft.x, rect.bottomRight.x), x0 + 1);
+            float                y1   = MAX(MAX(rect.topLeft.y, rect.bottomRight.y), y0 + 1);
+            region[0]                 = (unsigned int)x0;
+            region[1]                 = (unsigned int)y0;
+            region[2]                 = (unsigned int)ceilf(x1) - region[0];
+            region[3]                 = (unsigned int)ceilf(y1) - region[1];
+        }
+        if (!mRequestValid || memcmp(region, mRequested, sizeof(region)) != 0)
+        {
+            memcpy(mRequested, region, sizeof(region));
+            mRequestValid = true;
+            mStats.requestRegion(region[0], region[1], region[2], region[3]);
+        }
+        if (mStats.fetchResult(mResult))
+        {
+            mHasResult = true;
+            updateHistograms();
+        }
+
+        // the integral images follow the region and the cursor at once, the histograms come a bit later
+        ImageRegionMean mean;
+        if (mRegionIndex >= 0 && mStats.queryMean(region[0], region[1], region[2], region[3], mean))
+        {
+            string text = "Region Mean:";
+            for (int c = 0; c < mean.channelCount; c++)
+                text += combineString(" ", mean.name[c], " ", std::to_string((int)(mean.mean[c] + 0.5)), "±",
+                                      std::to_string((int)(mean.stddev[c] + 0.5)));
+            TextUnformatted(text.c_str());
+        }
+        if (mCursor.x >= 0 && mCursor.y >= 0
+            && mStats.queryMean((unsigned int)MAX(mCursor.x - 4, 0.f), (unsigned int)MAX(mCursor.y - 4, 0.f), 9, 9, mean))
+        {
+            string text = "Cursor 9x9 Mean:";
+            for (int c = 0; c < mean.channelCount; c++)
+                text += combineString(" ", mean.name[c], " ", std::to_string((int)(mean.mean[c] + 0.5)));
+            TextUnformatted(text.c_str());
+        }
+
+        if (!mHasResult)
+        {
+            TextUnformatted("Computing...");
+            return;
+        }
+
+        Text("%ux%u at (%u, %u), %.1f ms", mResult.width, mResult.height, mResult.x, mResult.y, mResult.computeMs);
+        if (BeginTable("stats", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            TableSetupColumn("Channel");
+            TableSetupColumn("Min");
+            TableSetupColumn("Max");
+            TableSetupColumn("Mean");
+            TableSetupColumn("Std");
+            TableSetupColumn("Clip Low");
+            TableSetupColumn("Clip High");
+            TableHeadersRow();
+            for (int c = 0; c < mResult.channelCount; c++)
+            {
+                const ImageChannelStats &channel = mResult.channels[c];
+                double                   count   = channel.count > 0 ? (double)channel.count : 1;
+                TableNextRow();
+                TableNextColumn();
+                TextUnformatted(channel.name);
+                TableNextColumn();
+                Text("%u", channel.min);
+                TableNextColumn();
+                Text("%u", channel.max);
+                TableNextColumn();
+                Text("%.2f", channel.mean);
+                TableNextColumn();
+                Text("%.2f", channel.stddev);
+                TableNextColumn();
+                Text("%.2f%%", channel.clippedLow * 100 / count);
+                TableNextColumn();
+                Text("%.2f%%", channel.clippedHigh * 100 / count);
+            }
+            EndTable();
+        }
+
+        for (int c = 0; c < mResult.channelCount; c++)
+        {
+            const ImageChannelStats &channel = mResult.channels[c];
+
+            ImU32 color = GetColorU32(ImGuiCol_PlotHistogram);
+            if (channel.name[0] == 'R')
+                color = IM_COL32(230, 70, 70, 255);
+            else if (channel.name[0] == 'G')
+                color = IM_COL32(70, 190, 70, 255);
+            else if (channel.name[0] == 'B')
+                color = IM_COL32(70, 110, 230, 255);
+
+            char overlay[32];
+            snprintf(overlay, sizeof(overlay), "%s 0 ~ %u", channel.name, channel.maxValue);
+            PushStyleColor(ImGuiCol_PlotHistogram, color);
+            PushID(c);
+            PlotHistogram("##histogram", mHistograms[c], IMGUI_STATS_HISTOGRAM_BINS, 0, overlay, 0, FLT_MAX,
+                          ImVec2(-1, GetFontSize() * 4));
+            PopID();
+            PopStyleColor();
+        }
+    }
+
+    void ImageWindow::show()
+    {
+        // the first time the statistics are shown, put them right of the image
+        if (mStatsDockPending)
+        {
+            mStatsDockPending = false;
+            if (mDockID != 0)
+            {
+                ImGuiID statsDock = 0;
+                ImGuiID imageDock = 0;
+                splitDock(mDockID, ImGuiDir_Right, 0.3f, &statsDock, &imageDock);
+                DockBuilderDockWindow((mTitle + " Statistics").c_str(), statsDock);
+            }
+            else
+            {
+                mStatsWindow.setPos(ImVec2(mWinPos.x + mWinSize.x, mWinPos.y), ImGuiCond_Appearing);
+                mStatsWindow.setSize(ImVec2(GetFontSize() * 24, mWinSize.y), ImGuiCond_Appearing);
+            }
+        }
+
+        IImGuiWindow::show();
+        mStatsWindow.show();
+    }
+
     void ImageWindow::showContent()
     {
+        mDockID = mIsChildWindow ? 0 : GetWindowDockID();
+        if (mStatsWindow.isOpened())
+        {
+            vector<DrawRectParam> rects;
+            for (auto &param : mDrawList)
+            {
+                if (auto pval = std::get_if<DrawRectParam>(&param.param))
+                    rects.push_back(*pval);
+            }
+            mStatsWindow.setRegions(rects, mDisplayInfo.mousePos);
+        }
+
+        if (mFrameSource && mFrameSource->update(mFrameTexture))
+            setTexture(mFrameTexture);
+        if (mTiledImage)
+        {
+            // geometry only, the pixels come from the tiles
+            mTexture.width  = mTiledImage->width();
+            mTexture.height = mTiledImage->height();
+        }
+
         bool oneOnOne = false;
         if (mControlButtonEnable)
         {
@@ -479,6 +1080,12 @@ namespace ImGui
                 if (mLinkWith)
                     mLinkWith->resetScale();
             }
+            if (mStatsWindow.hasImage())
+            {
+                SameLine();
+                if (Button("Stats"))
+                    showStatistics(!mStatsWindow.isOpened());
+            }
         }
         PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
         BeginChild((mTitle + "render").c_str(), ImVec2(0, 0), ImGuiChildFlags_Borders,
@@ -506,7 +1113,8 @@ namespace ImGui
 
         auto transThickness = [&](float thickness) { return thickness * imgScaledSize.x / mTexture.width; };
 
-        if (0 == mTexture.textureID[0])
+        mImageScreenSize = {0, 0};
+        if (0 == mTexture.textureID[0] && (!mTiledImage || mTexture.width <= 0 || mTexture.height <= 0))
             goto _CHILD_OVER_;
 
         winSize      = GetWindowSize();
@@ -539,11 +1147,40 @@ namespace ImGui
 
         winShowStartPos = {(winSize.x - imgScaledShowSize.x) / 2, (winSize.y - imgScaledShowSize.y) / 2};
         ImGui::SetCursorPos(winShowStartPos);
-        imgStartPosScreen = GetCursorScreenPos();
-        Image((ImTextureID)(uintptr_t)&mTexture, imgScaledShowSize,
-              {mImageShowPos.x / mTexture.width, mImageShowPos.y / mTexture.height}, // normalize to [0, 1]
-              {(imgScaledShowPos.x + imgScaledShowSize.x) / imgScaledSize.x,
-               (imgScaledShowPos.y + imgScaledShowSize.y) / imgScaledSize.y});
+        imgStartPosScreen    = GetCursorScreenPos();
+        mImageScreenPos      = imgStartPosScreen;
+        mImageScreenSize     = imgScaledShowSize;
+        mImageOnMainViewport = GetWindowViewport() == GetMainViewport();
+        if (mTiledImage)
+        {
+            // source pixels in view, each tile is clipped to it
+            float  pixelScale = imgScaledSize.x / mTexture.width;
+            ImVec2 viewSize   = imgScaledShowSize / pixelScale;
+            auto  &tiles      = mTiledImage->updateRegion(mTiledImage->getLevel(pixelScale), mImageShowPos, viewSize,
+                                                          mTexture.sampleType);
+            for (auto tile : tiles)
+            {
+                ImVec2 tilePos(tile->x, tile->y);
+                ImVec2 tileSize(tile->width, tile->height);
+                ImVec2 clipMin = ImMax(tilePos, mImageShowPos);
+                ImVec2 clipMax = ImMin(tilePos + tileSize, mImageShowPos + viewSize);
+                if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y)
+                    continue;
+                addImageCommand(GetWindowDrawList(), tile->renderSource,
+                                imgStartPosScreen + (clipMin - mImageShowPos) * pixelScale,
+                                imgStartPosScreen + (clipMax - mImageShowPos) * pixelScale, (clipMin - tilePos) / tileSize,
+                                (clipMax - tilePos) / tileSize);
+            }
+            Dummy(imgScaledShowSize);
+        }
+        else
+        {
+            addImageCommand(GetWindowDrawList(), mTexture, imgStartPosScreen, imgStartPosScreen + imgScaledShowSize,
+                            {mImageShowPos.x / mTexture.width, mImageShowPos.y / mTexture.height}, // normalize to [0, 1]
+                            {(imgScaledShowPos.x + imgScaledShowSize.x) / imgScaledSize.x,
+                             (imgScaledShowPos.y + imgScaledShowSize.y) / imgScaledSize.y});
+            Dummy(imgScaledShowSize);
+        }
 
         for (auto &param : mDrawList)
         {
@@ -720,7 +1357,7 @@ namespace ImGui
         EndChild();
     }
 
-    ImageWindow::ImageWindow(std::string title, bool embed) : IImGuiWindow(title)
+    ImageWindow::ImageWindow(std::string title, bool embed) : IImGuiWindow(title), mStatsWindow(title + " Statistics")
     {
         mIsChildWindow = embed;
         if (embed)
@@ -734,7 +1371,17 @@ namespace ImGui
 
     void ImageWindow::setTexture(TextureSource &texture)
     {
-        mTexture = RenderSource(texture, mTexture.sampleType);
+        mTiledImage = nullptr;
+        mTexture    = RenderSource(texture, mTexture.sampleType);
+    }
+    void ImageWindow::setTiledImage(TiledImage *image)
+    {
+        mTexture    = RenderSource(mTexture.sampleType);
+        mTiledImage = image;
+    }
+    void ImageWindow::setFrameSource(SharedFrameSource *source)
+    {
+        mFrameSource = source;
     }
     void ImageWindow::setSampleType(ImGuiImageSampleType sampleType)
     {
@@ -822,10 +1469,47 @@ namespace ImGui
         mDrawList.clear();
     }
 
+    bool ImageWindow::captureImage(const FrameCaptureCallback &callback)
+    {
+        if (mImageScreenSize.x <= 0 || mImageScreenSize.y <= 0)
+        {
+            dbg("no image shown in %s\n", mTitle.c_str());
+            return false;
+        }
+        if (!mImageOnMainViewport)
+        {
+            dbg("%s is not on the main viewport, can not be captured\n", mTitle.c_str());
+            return false;
+        }
+        return captureFrame(callback, mImageScreenPos, mImageScreenSize);
+    }
+
+    bool ImageWindow::setStatisticsImage(const ImageData &image)
+    {
+        return mStatsWindow.setImage(image);
+    }
+
+    void ImageWindow::showStatistics(bool show)
+    {
+        if (show == mStatsWindow.isOpened())
+            return;
+        if (show)
+        {
+            mStatsWindow.open();
+            mStatsDockPending = true;
+        }
+        else
+        {
+            mStatsWindow.close();
+        }
+    }
+
     void ImageWindow::clear()
     {
-        mTexture = RenderSource(mTexture.sampleType);
+        mTexture    = RenderSource(mTexture.sampleType);
+        mTiledImage = nullptr;
         clearDrawList();
+        mStatsWindow.clear();
     }
 
     void splitDock(ImGuiID dock, ImGuiDir splitDir, float sizeRatioDir, ImGuiID *outDockDir, ImGuiID *outDockOppositeDir)
@@ -1,6 +1,9 @@
 #ifndef _IMGUI_TOOLS_H_
 #define _IMGUI_TOOLS_H_
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <variant>
 #include <vector>
 #include <string>
@@ -12,10 +15,21 @@
 
 #include "ImGuiWindow.h"
 #include "imgui_image_render.h"
+#include "imgui_image_stats.h"
+#include "imgui_shared_frame.h"
 
 #define MOUSE_IN_WINDOW(mousePos, winPos, winSize)                                                             \
     (((mousePos).x >= (winPos).x) && ((mousePos).x < (winPos).x + (winSize).x) && ((mousePos).y >= (winPos).y) \
      && ((mousePos).y < (winPos).y + (winSize).y))
+
+#define IMGUI_LOG_RING_CHUNKS     4096               // appends waiting for the UI thread, a power of 2
+#define IMGUI_LOG_RING_MAX_BYTES  (16 * 1024 * 1024) // appends beyond it are dropped
+#define IMGUI_LOG_DRAIN_BUDGET_MS 4                  // parsing time of the waiting appends per frame
+#define IMGUI_LOG_DRAIN_SLICE     (64 * 1024)        // bytes parsed between two checks of the budget
+#define IMGUI_LOG_ARENA_SIZE      (1024 * 1024)      // log text is stored in arenas of this size
+#define IMGUI_LOG_MAX_BYTES       (64 * 1024 * 1024) // default capacity, at least two arenas are kept
+#define IMGUI_LOG_MAX_LINES       1000000
+
 namespace ImGui
 {
     typedef enum
@@ -44,7 +58,8 @@ namespace ImGui
 
     struct DisplayText
     {
-        std::string   text;
+        uint64_t      offset  = 0; // in the log arenas
+        uint32_t      length  = 0;
         TextColorCode color   = ColorNone;
         bool          endLine = false;
     };
@@ -55,31 +70,124 @@ namespace ImGui
         LoggerWindow(std::string title, bool embed = false);
         virtual ~LoggerWindow();
 
+        // parses the waiting appends, call it every frame even while the window is closed
+        virtual void show() override;
+
         void setWordWrap(bool wordWrap);
 
+        // any thread, never blocks: the text waits in a ring for show() and is dropped when the ring is full
         void appendString(const char *fmt, ...);
         void appendString(const std::string &str);
+        void appendString(std::string &&str);
         void clear();
 
+        // the oldest lines are evicted beyond either limit
+        void setCapacity(size_t maxLines, size_t maxBytes);
+
         void copyToClipBoard();
 
     private:
+        // a line of the log, the DisplayTexts up to one with endLine
+        struct LogLine
+        {
+            size_t       firstText;
+            size_t       textCount;
+            float        width;      // unwrapped
+            size_t       row;        // visual rows before this line, evicted ones included
+            unsigned int rows;
+            size_t       firstBreak; // rows - 1 breaks from mBreaksBase
+        };
+
+        // where a wrapped row starts
+        struct LogBreak
+        {
+            uint32_t text;   // from the first text of the line
+            uint32_t offset; // in bytes
+        };
+
         void         displayTexts();
         virtual void showContent() override;
 
+        void  updateLineIndex(float wrapWidth);
+        float measureText(const char *begin, const char *end);
+        void  layoutLine(LogLine &line);
+        void  drawLine(const LogLine &line);
+
+        void         parseLogs(const char *begin, const char *end);
+        DisplayText &currentText();
+
+        // fixed size block of log text, base is its offset in all the text ever stored
+        struct LogArena
+        {
+            uint64_t                base;
+            std::unique_ptr<char[]> data;
+        };
+
+        void               appendText(const char *str, size_t length);
+        void               addArena();
+        void               evictArena();
+        void               evictFrontLine();
+        void               trimLogs();
+        void               releaseArenas();
+        const DisplayText &textAt(size_t index) const { return mLogs[index - mEvictedTexts]; }
+        const char        *textData(const DisplayText &text) const;
+
+        // slot of the chunk ring, the sequence tells whether it is free for producers or filled for the UI thread
+        struct LogChunk
+        {
+            std::atomic<size_t> sequence;
+            std::string         text;
+        };
+
+        void pushChunk(std::string &&text);
+        bool popChunk(std::string &text);
+        void drainChunks();
+
     private:
-        std::vector<DisplayText> mLogs;
+        // texts of the stored lines, indices count from the first text ever stored
+        std::deque<DisplayText> mLogs;
+        size_t                  mEvictedTexts = 0;
+        size_t                  mLineCount    = 0;
+        size_t                  mMaxLines     = IMGUI_LOG_MAX_LINES;
+        size_t                  mMaxArenas    = IMGUI_LOG_MAX_BYTES / IMGUI_LOG_ARENA_SIZE;
+
+        // ring of the arenas, the oldest one is evicted with its lines and its buffer reused
+        std::deque<LogArena>    mArenas;
+        std::unique_ptr<char[]> mSpareArena;
+        uint64_t                mNextArenaBase = 0;
+        uint64_t                mWritePos      = 0;
 
         StdMutex    mLogLock;
-        std::string bufferStr;
+        std::string mPendingControl; // escape sequence or '\r' cut at the end of the last append
         bool        mScrollLocked = false;
         bool        mWordWrap     = false;
 
-        std::vector<std::string> mShowLogs;
-
         bool  mLogsChanged  = false;
-        float mTotalLines   = 0;
         float mMaxLineWidth = 0;
+
+        // index of the lines in mLogs, extended as logs arrive so a frame only touches the visible lines
+        std::deque<LogLine> mLines;
+        size_t              mIndexedTexts   = 0;
+        bool                mLastLineOpen   = false; // measured again until it was indexed with its end
+        size_t              mFirstRow       = 0; // of the first indexed line, rows before it are evicted
+        size_t              mTotalRows      = 0;
+        float               mIndexWrapWidth = 0; // 0 without word wrap
+        ImFont             *mIndexFont      = nullptr;
+        float               mIndexFontSize  = 0;
+
+        // wrap layout of the lines wider than mIndexWrapWidth, in line order
+        std::deque<LogBreak> mBreaks;
+        size_t               mBreaksBase = 0; // breaks of the evicted lines
+
+        // bounded multi-producer ring of the appended texts, drained by the UI thread only
+        std::unique_ptr<LogChunk[]> mChunks;
+        std::atomic<size_t>         mChunkPushPos{0};
+        size_t                      mChunkPopPos = 0;
+        std::string                 mDrainText; // popped append, parsed over several frames when large
+        size_t                      mDrainOffset = 0;
+        std::atomic<size_t>         mQueuedBytes{0};
+        std::atomic<uint64_t>       mDroppedChunks{0};
+        std::atomic<uint64_t>       mDroppedBytes{0};
     };
 
     struct DisplayInfo
@@ -151,15 +259,51 @@ namespace ImGui
         DrawParam(DrawType type, const DrawTextParam &text);
     };
 
+    // histograms and statistics of an image for ImageWindow, see ImageWindow::setStatisticsImage()
+    class ImageStatsWindow : public IImGuiWindow
+    {
+    public:
+        ImageStatsWindow(std::string title);
+
+        bool setImage(const ImageData &image);
+        void clear();
+        bool hasImage();
+        // the rects to choose the region from and the cursor in image pixels, negative outside of the image
+        void setRegions(const std::vector<DrawRectParam> &rects, ImVec2 cursor);
+
+    protected:
+        virtual void showContent() override;
+
+    private:
+        void updateHistograms();
+
+        ImageStatistics            mStats;
+        std::vector<DrawRectParam> mRects;
+        ImVec2                     mCursor       = {-1, -1};
+        int                        mRegionIndex  = -1; // -1 for the whole image
+        unsigned int               mRequested[4] = {};
+        bool                       mRequestValid = false;
+        bool                       mHasResult    = false;
+        bool                       mLogScale     = false;
+        ImageRegionStats           mResult       = {};
+        float                      mHistograms[IMGUI_STATS_MAX_CHANNELS][IMGUI_STATS_HISTOGRAM_BINS];
+    };
+
     class ImageWindow : public IImGuiWindow
     {
     public:
         ImageWindow(std::string title, bool embed = false);
 
+        virtual void show() override;
+
         void setControlButtonEnable(bool enable);
 
         // texture must be available since show() called utill ImGui::Render() Called!!
         void                 setTexture(TextureSource &texture);
+        // show the newest frame of source, uploaded straight from shared memory. source must outlive the window
+        void                 setFrameSource(SharedFrameSource *source);
+        // show an image of any size through its resident tiles, image must outlive the window
+        void                 setTiledImage(TiledImage *image);
         void                 setSampleType(ImGuiImageSampleType sampleType);
         ImGuiImageSampleType getSampleType();
         void                 clear();
@@ -177,6 +321,14 @@ namespace ImGui
         void setDrawList(const std::vector<DrawParam> &drawList);
         void clearDrawList();
 
+        // read back the image area as shown, overlays included, at the next render. see captureFrame()
+        bool captureImage(const FrameCaptureCallback &callback);
+
+        // CPU side of the shown image for the statistics panel opened by the "Stats" button,
+        // the planes are copied unless image.holder keeps them alive
+        bool setStatisticsImage(const ImageData &image);
+        void showStatistics(bool show);
+
     protected:
         virtual void showContent() override;
         void         handleWheelY(ImVec2 &mouseInWindow);
@@ -194,12 +346,26 @@ namespace ImGui
         bool   mMouseLeftPressed = false;
         ImVec2 mLastMousePos     = {0, 0};
 
+        // screen area of the image in the last frame, for captureImage()
+        ImVec2 mImageScreenPos      = {0, 0};
+        ImVec2 mImageScreenSize     = {0, 0};
+        bool   mImageOnMainViewport = true;
+
         ImageWindow          *mLinkWith   = nullptr;
         std::function<bool()> mUnlinkCond = []() { return false; };
 
         std::vector<DrawParam> mDrawList;
 
         bool mControlButtonEnable = true;
+
+        SharedFrameSource *mFrameSource = nullptr;
+        TextureSource      mFrameTexture;
+
+        TiledImage *mTiledImage = nullptr;
+
+        ImageStatsWindow mStatsWindow;
+        ImGuiID          mDockID           = 0;
+        bool             mStatsDockPending = false; // dock the statistics next to the image at the next show()
     };
 
     class ImGuiBinaryViewer : public IImGuiWindow
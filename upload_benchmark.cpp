@@ -0,0 +1,145 @@
+// Benchmark of updateImageTexture() with tightly packed planes, padded strides, strides that are not a whole
+// number of pixels (the only case still repacked on the CPU) and a ROI of a larger image, reported in ms and MPix/s
+// usage: uploadBenchmark [width] [height] [iterations], the window closes once the results are printed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "ImGuiApplication.h"
+
+using std::vector;
+using namespace ImGui;
+
+struct BenchFormat
+{
+    ImGuiImageFormat format;
+    const char      *name;
+};
+
+static const BenchFormat gFormats[] = {
+    {ImGuiImageFormat_RGBA,    "RGBA"   },
+    {ImGuiImageFormat_YUV420P, "YUV420P"},
+    {ImGuiImageFormat_NV12,    "NV12"   },
+    {ImGuiImageFormat_P010,    "P010"   },
+};
+
+// planes of format with padding bytes after each row, stored in buffer
+static bool makeImage(ImGuiImageFormat format, unsigned int width, unsigned int height, unsigned int padding,
+                      vector<uint8_t> &buffer, ImageData &image)
+{
+    image            = {};
+    image.format     = format;
+    image.width      = width;
+    image.height     = height;
+    image.colorRange = ImGuiImageColorRange_16_235;
+
+    unsigned int planeCount                        = getPlaneCount(format);
+    size_t       planeSize[IMGUI_IMAGE_MAX_PLANES] = {0};
+    size_t       totalSize                         = 0;
+    for (unsigned int i = 0; i < planeCount; i++)
+    {
+        unsigned int bytesPerPixel = 0;
+        unsigned int planeWidth    = 0;
+        unsigned int planeHeight   = 0;
+        if (getPlaneInfo(format, width, height, i, &bytesPerPixel, &planeWidth, &planeHeight) < 0)
+            return false;
+        image.stride[i] = planeWidth * bytesPerPixel + padding;
+        planeSize[i]    = (size_t)image.stride[i] * planeHeight;
+        totalSize += planeSize[i];
+    }
+
+    buffer.resize(totalSize);
+    for (size_t i = 0; i < totalSize; i++)
+        buffer[i] = (uint8_t)(i * 7 + (i >> 11));
+
+    uint8_t *plane = buffer.data();
+    for (unsigned int i = 0; i < planeCount; i++)
+    {
+        image.plane[i] = plane;
+        plane += planeSize[i];
+    }
+    return true;
+}
+
+class Application : public ImGuiApplication
+{
+public:
+    virtual void presetInternal() override { mApplicationName = "Upload Benchmark"; }
+    virtual void transferCmdArgs(std::vector<std::string> &args) override;
+    // runs once on the first frame, with the render context current
+    virtual bool renderUI() override;
+
+private:
+    // upload image iterations times into texture, average ms per upload
+    double measureUpload(ImageData &image, TextureSource &texture);
+
+    unsigned int mWidth      = 1920;
+    unsigned int mHeight     = 1080;
+    int          mIterations = 100;
+};
+
+Application imguiApp;
+
+void Application::transferCmdArgs(std::vector<std::string> &args)
+{
+    if (args.size() > 1)
+        mWidth = (unsigned int)atoi(args[1].c_str());
+    if (args.size() > 2)
+        mHeight = (unsigned int)atoi(args[2].c_str());
+    if (args.size() > 3)
+        mIterations = atoi(args[3].c_str());
+}
+
+double Application::measureUpload(ImageData &image, TextureSource &texture)
+{
+    // the first upload allocates the texture, the following ones reuse it
+    updateImageTexture(image, texture);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < mIterations; i++)
+        updateImageTexture(image, texture);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1000 / mIterations;
+}
+
+bool Application::renderUI()
+{
+    if (mWidth < 4 || mHeight < 4 || mIterations <= 0)
+    {
+        fprintf(stderr, "invalid arguments %ux%u x%d\n", mWidth, mHeight, mIterations);
+        return true;
+    }
+    mWidth &= ~3u;
+    mHeight &= ~1u;
+
+    // the ROI is cut from the middle of an image larger by this in both directions
+    const unsigned int roiBorder = 64;
+
+    printf("%ux%u, %d iterations, ms per upload (MPix/s)\n", mWidth, mHeight, mIterations);
+    printf("%-10s%21s%21s%21s%21s\n", "", "unpadded", "stride +64", "stride +1", "roi");
+    for (const auto &format : gFormats)
+    {
+        vector<uint8_t> buffers[4];
+        ImageData       images[4];
+        if (!makeImage(format.format, mWidth, mHeight, 0, buffers[0], images[0]) ||
+            !makeImage(format.format, mWidth, mHeight, 64, buffers[1], images[1]) ||
+            !makeImage(format.format, mWidth, mHeight, 1, buffers[2], images[2]))
+            continue;
+        ImageData parent;
+        if (!makeImage(format.format, mWidth + roiBorder, mHeight + roiBorder, 0, buffers[3], parent) ||
+            !getImageDataROI(parent, roiBorder / 2, roiBorder / 2, mWidth, mHeight, images[3]))
+            continue;
+
+        printf("%-10s", format.name);
+        TextureSource texture;
+        for (auto &image : images)
+        {
+            double ms = measureUpload(image, texture);
+            printf("%10.3f (%8.1f)", ms, (double)mWidth * mHeight / ms / 1000);
+        }
+        printf("\n");
+    }
+
+    return true;
+}